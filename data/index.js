@@ -12,6 +12,23 @@
 // COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
 // ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+function newRequestId()
+{
+    return Date.now().toString(36) + Math.random().toString(36).substring(2, 6);
+}
+
+// Every click sends a new request id, so the controller can tell reloads and back navigation from new clicks.
+document.addEventListener("click", function (event)
+{
+    const link = event.target.closest("a[href^='/get?']");
+    if (link)
+    {
+        const url = new URL(link.href);
+        url.searchParams.set("id", newRequestId());
+        link.href = url.pathname + url.search;
+    }
+});
+
 function sendAbsoluteCommand(form) 
 {
     if (!form.living_room_door.checked && 
@@ -21,6 +38,7 @@ function sendAbsoluteCommand(form)
     {
         return;
     }
+    form.elements["id"].value = newRequestId();
     form.action = "/get?shutter_scale=" + form.shutter_scale.value;
     if (form.living_room_door.checked)
     {
@@ -40,6 +58,41 @@ function sendAbsoluteCommand(form)
     }
 }
 
+function saveScene(form) 
+{
+    const requestBody = {"id": Number(form.scene_id.value), "name": "scene " + form.scene_id.value};
+    const position = Number(form.shutter_scale.value);
+    if (form.living_room_door.checked)
+    {
+        requestBody.living_room_door = position;
+    }
+    if (form.living_room_window.checked)
+    {
+        requestBody.living_room_window = position;
+    }
+    if (form.bedroom_door.checked)
+    {
+        requestBody.bedroom_door = position;
+    }
+    if (form.bedroom_window.checked)
+    {
+        requestBody.bedroom_window = position;
+    }
+    const requestOptions = 
+    {
+        method: 'POST',
+        headers: {'Content-Type': 'application/json', 
+    },
+        body: JSON.stringify(requestBody)
+    };
+
+    fetch("/api/scene", requestOptions)
+        .catch(function (err) 
+        {
+            console.log("Something went wrong!", err)
+        });
+}
+
 function calibrate(shutter_num) 
 {
     const requestBody = {"calibrate": shutter_num};
@@ -0,0 +1,81 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "admission_control.h"
+
+AdmissionControl::Verdict AdmissionControl::admit(std::uint32_t client, unsigned long now_ms)
+{
+    if (in_flight_ >= max_in_flight)
+    {
+        ++overloaded_;
+        return Verdict::OVERLOADED;
+    }
+
+    auto& bucket = bucketOf(client, now_ms);
+    const unsigned long earned = (now_ms - bucket.refilled_ms) / refill_ms;
+    if (earned > 0)
+    {
+        const unsigned long missing = burst - bucket.tokens;
+        bucket.tokens = earned >= missing ? burst : bucket.tokens + earned;
+        bucket.refilled_ms += earned * refill_ms;
+    }
+    if (bucket.tokens == 0)
+    {
+        ++rate_limited_;
+        return Verdict::RATE_LIMITED;
+    }
+    --bucket.tokens;
+    ++in_flight_;
+    return Verdict::ADMITTED;
+}
+
+void AdmissionControl::release()
+{
+    if (in_flight_ > 0)
+    {
+        --in_flight_;
+    }
+}
+
+AdmissionControl::Bucket& AdmissionControl::bucketOf(std::uint32_t client, unsigned long now_ms)
+{
+    Bucket* oldest = &buckets_[0];
+    for (auto& bucket : buckets_)
+    {
+        if (bucket.client == client && bucket.client != 0)
+        {
+            return bucket;
+        }
+        if (now_ms - bucket.refilled_ms > now_ms - oldest->refilled_ms)
+        {
+            oldest = &bucket;
+        }
+    }
+    // A full bucket for a new client.
+    oldest->client = client;
+    oldest->tokens = burst;
+    oldest->refilled_ms = now_ms;
+    return *oldest;
+}
+
+unsigned long AdmissionControl::rateLimited() const
+{
+    return rate_limited_;
+}
+
+unsigned long AdmissionControl::overloaded() const
+{
+    return overloaded_;
+}
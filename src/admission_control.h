@@ -0,0 +1,84 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Class limiting the web requests: a global limit of the responses in flight and a token bucket per client.
+///
+/// Rejections cost a table lookup and an empty response, so a flood cannot starve the socket pool or the inbox.
+/// Only used from the async web server context.
+class AdmissionControl
+{
+public:
+    /// @brief Enum for the admission verdict.
+    enum Verdict
+    {
+        ADMITTED,
+        /// @brief The client exhausted its tokens, answered with 429.
+        RATE_LIMITED,
+        /// @brief Too many responses in flight, answered with 503.
+        OVERLOADED
+    };
+
+    /// @brief The number of responses streamed at once (the ESP8266 has only a handful of sockets).
+    static const std::size_t max_in_flight = 3;
+    /// @brief The number of clients tracked, the least recently seen one is replaced.
+    static const std::size_t client_count = 8;
+    /// @brief The number of requests a client may send at once.
+    static const std::uint16_t burst = 6;
+    /// @brief The time to earn a token back [ms].
+    static const std::uint16_t refill_ms = 500;
+
+    /// @brief Admits a request, taking a slot in flight and a token of the client.
+    /// @param client The IPv4 address of the client.
+    /// @param now_ms The current time [ms].
+    /// @return The verdict, the slot has to be released if admitted.
+    Verdict admit(std::uint32_t client, unsigned long now_ms);
+
+    /// @brief Releases the slot of an admitted request, when its response is finished.
+    void release();
+
+    /// @brief Returns the number of requests rejected by the token buckets since boot.
+    /// @return The number of rate limited requests.
+    unsigned long rateLimited() const;
+
+    /// @brief Returns the number of requests rejected by the in-flight limit since boot.
+    /// @return The number of overloaded requests.
+    unsigned long overloaded() const;
+
+private:
+    /// @brief Struct encapsulating the token bucket of a client.
+    struct Bucket
+    {
+        std::uint32_t client = 0;
+        std::uint16_t tokens = 0;
+        /// @brief The time the tokens were last refilled or the client last seen [ms].
+        unsigned long refilled_ms = 0;
+    };
+
+    /// @brief Returns the bucket of a client, replacing the least recently seen one for a new client.
+    Bucket& bucketOf(std::uint32_t client, unsigned long now_ms);
+
+    /// @brief The token buckets.
+    std::array<Bucket, client_count> buckets_;
+    /// @brief The number of admitted requests whose response is not finished.
+    std::size_t in_flight_ = 0;
+    unsigned long rate_limited_ = 0;
+    unsigned long overloaded_ = 0;
+};
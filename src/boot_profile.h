@@ -0,0 +1,57 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <array>
+
+/// @brief Struct recording the time at which each boot phase finished.
+struct BootProfile
+{
+    /// @brief Enum for the boot phases, in order.
+    enum Phase
+    {
+        FILESYSTEM,
+        SCENES,
+        SERVICES,
+        WIFI,
+        PHASE_COUNT
+    };
+
+    /// @brief Records the end of a phase.
+    /// @param phase The finished phase.
+    /// @param now_ms The current time [ms].
+    void mark(Phase phase, unsigned long now_ms)
+    {
+        phase_end_ms[phase] = now_ms;
+        finished[phase] = true;
+    }
+
+    /// @brief Returns the name of a phase.
+    /// @param phase The phase.
+    /// @return The name of the phase.
+    static const char* name(Phase phase)
+    {
+        static const char* const names[PHASE_COUNT] = {"filesystem", "scenes", "services", "wifi"};
+        return names[phase];
+    }
+
+    /// @brief The time each phase finished, measured from boot [ms].
+    std::array<unsigned long, PHASE_COUNT> phase_end_ms {};
+    /// @brief Stores if a phase has finished.
+    std::array<bool, PHASE_COUNT> finished {};
+    /// @brief Stores if the filesystem could be mounted. Without it the controller runs degraded:
+    /// no page, no scenes, no cached WiFi parameters.
+    bool filesystem_ok = false;
+};
@@ -0,0 +1,356 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "cluster_node.h"
+
+ClusterNode::ClusterNode(ShutterController& controller, const Config& config):
+    controller_(controller),
+    config_(config)
+{
+}
+
+void ClusterNode::begin()
+{
+    udp_.begin(config_.port);
+    controller_.setForwarder(&ClusterNode::forward, this);
+    updateOwners();
+}
+
+bool ClusterNode::forward(void* context, const Request& request)
+{
+    auto& node = *static_cast<ClusterNode*>(context);
+    const auto owner_id = node.owners_[request.device];
+    const Peer* owner = node.peerOf(owner_id);
+    if (owner == nullptr || node.awaited_node_id_ != no_owner)
+    {
+        return false;
+    }
+    uint8_t buffer[ClusterProtocol::forward_size];
+    const auto size = ClusterProtocol::encodeForward(node.config_.node_id, ++node.forward_sequence_, request, buffer);
+    node.awaited_node_id_ = owner_id;
+    node.acknowledged_ = false;
+    for (int attempt = 0; attempt < ClusterParams::forward_attempts && !node.acknowledged_; ++attempt)
+    {
+        // The owner is looked up again, an announcement received while waiting may move its address.
+        owner = node.peerOf(owner_id);
+        if (owner == nullptr)
+        {
+            break;
+        }
+        node.udp_.beginPacket(owner->address, owner->port);
+        node.udp_.write(buffer, size);
+        node.udp_.endPacket();
+        const auto sent_ms = millis();
+        while (!node.acknowledged_ && millis() - sent_ms < ClusterParams::forward_ack_timeout_ms)
+        {
+            if (!node.receive(millis()))
+            {
+                delay(1);
+            }
+        }
+    }
+    node.awaited_node_id_ = no_owner;
+
+    if (!node.acknowledged_)
+    {
+        // Its shutters are taken over until it announces again.
+        Peer* silent = node.peerOf(owner_id);
+        if (silent != nullptr)
+        {
+            silent->active = false;
+            node.updateOwners();
+        }
+        ++node.forward_failures_;
+        return false;
+    }
+    ++node.forwarded_;
+    return true;
+}
+
+void ClusterNode::execute()
+{
+    const auto now_ms = millis();
+    for (std::size_t index = 0; index < deferred_count_; ++index)
+    {
+        controller_.submit(deferred_[index]);
+    }
+    deferred_count_ = 0;
+    for (int packet_num = 0; packet_num < max_packets_per_tick; ++packet_num)
+    {
+        if (!receive(now_ms))
+        {
+            break;
+        }
+    }
+
+    bool expired = false;
+    for (auto& peer : peers_)
+    {
+        if (peer.active && now_ms - peer.seen_ms > ClusterParams::peer_timeout_ms)
+        {
+            // Its shutters are taken over by the next controller reaching them.
+            peer.active = false;
+            expired = true;
+        }
+    }
+    if (expired)
+    {
+        updateOwners();
+    }
+    announce(now_ms);
+}
+
+bool ClusterNode::receive(unsigned long now_ms)
+{
+    const int size = udp_.parsePacket();
+    if (size <= 0)
+    {
+        return false;
+    }
+    uint8_t buffer[ClusterProtocol::max_size];
+    const auto read = udp_.read(buffer, sizeof(buffer));
+    uint8_t node_id = 0;
+    ClusterProtocol::Type type = ClusterProtocol::Type::ANNOUNCE;
+    if (static_cast<int>(read) != size || !ClusterProtocol::decodeHeader(buffer, read, node_id, type) ||
+        node_id == config_.node_id)
+    {
+        return true;
+    }
+
+    if (type == ClusterProtocol::Type::ANNOUNCE)
+    {
+        ClusterProtocol::Announcement announcement;
+        if (ClusterProtocol::decodeAnnouncement(buffer, read, announcement))
+        {
+            // Sent from the port the peer listens on.
+            onAnnouncement(announcement, udp_.remoteIP(), udp_.remotePort(), now_ms);
+        }
+        return true;
+    }
+    uint8_t sequence = 0;
+    if (type == ClusterProtocol::Type::ACK)
+    {
+        if (ClusterProtocol::decodeAck(buffer, read, sequence) && node_id == awaited_node_id_ &&
+            sequence == forward_sequence_)
+        {
+            acknowledged_ = true;
+        }
+        return true;
+    }
+    Request request;
+    if (ClusterProtocol::decodeForward(buffer, read, sequence, request))
+    {
+        onForward(node_id, sequence, request);
+    }
+    return true;
+}
+
+void ClusterNode::onForward(uint8_t node_id, uint8_t sequence, const Request& request)
+{
+    Peer* peer = peerOf(node_id);
+    // A repetition, the acknowledgement was lost.
+    const bool repeated = peer != nullptr && peer->forward_sequence == sequence;
+    if (!repeated)
+    {
+        if (awaited_node_id_ != no_owner)
+        {
+            if (deferred_count_ == deferred_.size())
+            {
+                // Not acknowledged, the sender repeats it.
+                return;
+            }
+            deferred_[deferred_count_++] = request;
+        }
+        else
+        {
+            controller_.submit(request);
+        }
+        if (peer != nullptr)
+        {
+            peer->forward_sequence = sequence;
+        }
+    }
+
+    uint8_t buffer[ClusterProtocol::ack_size];
+    const auto size = ClusterProtocol::encodeAck(config_.node_id, sequence, buffer);
+    udp_.beginPacket(udp_.remoteIP(), udp_.remotePort());
+    udp_.write(buffer, size);
+    udp_.endPacket();
+}
+
+void ClusterNode::onAnnouncement(const ClusterProtocol::Announcement& announcement, const IPAddress& address,
+    uint16_t port, unsigned long now_ms)
+{
+    Peer* slot = nullptr;
+    for (auto& peer : peers_)
+    {
+        if (peer.active && peer.announcement.node_id == announcement.node_id)
+        {
+            slot = &peer;
+            break;
+        }
+        if (!peer.active && slot == nullptr)
+        {
+            slot = &peer;
+        }
+    }
+    if (slot == nullptr)
+    {
+        // More controllers than max_peers.
+        return;
+    }
+    const bool changed = !slot->active || slot->announcement.reachable_mask != announcement.reachable_mask;
+    if (!slot->active)
+    {
+        // A new or returning controller, its sequence numbers may have restarted.
+        slot->forward_sequence = -1;
+    }
+    slot->active = true;
+    slot->announcement = announcement;
+    slot->address = address;
+    slot->port = port;
+    slot->seen_ms = now_ms;
+    if (changed)
+    {
+        updateOwners();
+    }
+
+    for (int device = 0; device < Shutter::Device::ALL; ++device)
+    {
+        if (owners_[device] != announcement.node_id || !(announcement.owned_mask & (1 << device)))
+        {
+            continue;
+        }
+        const auto& remote = announcement.states[device];
+        StateSnapshot::ShutterState state;
+        state.position = remote.position;
+        state.calibrated = remote.calibrated;
+        state.queued = remote.busy ? 1 : 0;
+        controller_.mirrorState(static_cast<Shutter::Device>(device), state);
+    }
+}
+
+void ClusterNode::updateOwners()
+{
+    unsigned char local_mask = 0;
+    for (int device = 0; device < Shutter::Device::ALL; ++device)
+    {
+        const unsigned char bit = 1 << device;
+        uint8_t owner = config_.reachable_mask & bit ? config_.node_id : no_owner;
+        for (const auto& peer : peers_)
+        {
+            const auto node_id = peer.announcement.node_id;
+            if (peer.active && (peer.announcement.reachable_mask & bit) && (owner == no_owner || node_id < owner))
+            {
+                owner = node_id;
+            }
+        }
+        owners_changed_ = owners_changed_ || owners_[device] != owner;
+        owners_[device] = owner;
+        // A shutter out of every controller's range is still tried locally.
+        if (owner == config_.node_id || owner == no_owner)
+        {
+            local_mask |= bit;
+        }
+    }
+    controller_.setLocalDevices(local_mask);
+}
+
+void ClusterNode::announce(unsigned long now_ms)
+{
+    const auto version = controller_.stateSnapshot().version();
+    const unsigned long elapsed_ms = now_ms - announced_ms_;
+    const bool changed = owners_changed_ || version != announced_version_;
+    if (elapsed_ms < ClusterParams::announce_period_ms && !(changed && elapsed_ms >= ClusterParams::min_announce_period_ms))
+    {
+        return;
+    }
+
+    ClusterProtocol::Announcement announcement;
+    announcement.node_id = config_.node_id;
+    announcement.reachable_mask = config_.reachable_mask;
+    for (int device = 0; device < Shutter::Device::ALL; ++device)
+    {
+        if (owners_[device] != config_.node_id)
+        {
+            continue;
+        }
+        const auto& state = controller_.stateSnapshot().state(device);
+        announcement.owned_mask |= 1 << device;
+        announcement.states[device].position = static_cast<uint8_t>(state.position);
+        announcement.states[device].calibrated = state.calibrated;
+        announcement.states[device].busy = state.queued > 0;
+    }
+    uint8_t buffer[ClusterProtocol::announce_size];
+    const auto size = ClusterProtocol::encodeAnnouncement(announcement, buffer);
+    for (uint8_t port_index = 0; port_index < config_.announce_port_count; ++port_index)
+    {
+        udp_.beginPacket(config_.announce_address, config_.announce_port + port_index);
+        udp_.write(buffer, size);
+        udp_.endPacket();
+    }
+    announced_ms_ = now_ms;
+    announced_version_ = version;
+    owners_changed_ = false;
+}
+
+const ClusterNode::Peer* ClusterNode::peerOf(uint8_t node_id) const
+{
+    for (const auto& peer : peers_)
+    {
+        if (peer.active && peer.announcement.node_id == node_id)
+        {
+            return &peer;
+        }
+    }
+    return nullptr;
+}
+
+ClusterNode::Peer* ClusterNode::peerOf(uint8_t node_id)
+{
+    for (auto& peer : peers_)
+    {
+        if (peer.active && peer.announcement.node_id == node_id)
+        {
+            return &peer;
+        }
+    }
+    return nullptr;
+}
+
+uint8_t ClusterNode::ownerOf(Shutter::Device device) const
+{
+    return owners_[device];
+}
+
+std::size_t ClusterNode::peers() const
+{
+    std::size_t count = 0;
+    for (const auto& peer : peers_)
+    {
+        count += peer.active;
+    }
+    return count;
+}
+
+unsigned long ClusterNode::forwarded() const
+{
+    return forwarded_;
+}
+
+unsigned long ClusterNode::forwardFailures() const
+{
+    return forward_failures_;
+}
@@ -0,0 +1,151 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "cluster_params.h"
+#include "cluster_protocol.h"
+#include "shutter_controller.h"
+
+#include <WiFiUdp.h>
+#include <array>
+
+/// @brief Class coordinating the controllers on the LAN. Polled from the control loop.
+///
+/// The controllers announce the shutters in their RF range and the state of the shutters they own. Every controller
+/// derives the same owners from the announcements: the lowest node id reaching a shutter. Requests of a shutter owned
+/// by another controller are forwarded to it, its state is mirrored into the local state snapshot.
+///
+/// A forwarded request is repeated until the owner acknowledges it. The wait blocks the control loop for at most
+/// ClusterParams::forward_attempts * ClusterParams::forward_ack_timeout_ms, an owner not answering is considered gone
+/// and the request is applied locally.
+class ClusterNode
+{
+public:
+    /// @brief Struct containing the configuration of a node, see ClusterParams.
+    struct Config
+    {
+        /// @brief The node id, unique on the LAN, starting from 1.
+        uint8_t node_id;
+        /// @brief The shutters in the RF range (bit n = Shutter::Device n).
+        uint8_t reachable_mask;
+        /// @brief The UDP port of the node.
+        uint16_t port;
+        /// @brief The address the announcements are sent to, the broadcast address on the LAN.
+        IPAddress announce_address;
+        /// @brief The announcements are sent to this many consecutive ports from announce_port (e.g. several nodes
+        /// on one host).
+        uint8_t announce_port_count;
+        /// @brief The first port the announcements are sent to.
+        uint16_t announce_port;
+    };
+
+    /// @brief The maximum number of other controllers.
+    static const std::size_t max_peers = 4;
+    /// @brief The owner of a shutter reached by no controller.
+    static const uint8_t no_owner = 0;
+
+    /// @brief Constructor.
+    /// @param controller The local controller.
+    /// @param config The configuration of the node.
+    ClusterNode(ShutterController& controller, const Config& config);
+
+    /// @brief Starts listening, and registers the forwarder in the controller.
+    void begin();
+
+    /// @brief Handles the pending datagrams, follows the other controllers and announces the state.
+    void execute();
+
+    /// @brief Returns the owner of a shutter.
+    /// @param device The shutter device.
+    /// @return The node id of the owner, no_owner if no controller reaches it.
+    uint8_t ownerOf(Shutter::Device device) const;
+
+    /// @brief Returns the number of the other controllers heard from recently.
+    /// @return The number of active peers.
+    std::size_t peers() const;
+
+    /// @brief Returns the number of requests forwarded to and acknowledged by other controllers since boot.
+    /// @return The number of forwarded requests.
+    unsigned long forwarded() const;
+
+    /// @brief Returns the number of requests not acknowledged by their owner since boot, applied locally instead.
+    /// @return The number of failed forwards.
+    unsigned long forwardFailures() const;
+
+private:
+    /// @brief Struct encapsulating another controller.
+    struct Peer
+    {
+        bool active = false;
+        ClusterProtocol::Announcement announcement;
+        IPAddress address;
+        uint16_t port = 0;
+        /// @brief The time of the last announcement [ms].
+        unsigned long seen_ms = 0;
+        /// @brief The sequence number of the last request forwarded by the peer, -1 if none.
+        int forward_sequence = -1;
+    };
+
+    /// @brief The forwarder registered in the controller.
+    static bool forward(void* context, const Request& request);
+
+    /// @brief Reads and handles one datagram.
+    /// @param now_ms The current time [ms].
+    /// @return False, if no datagram was pending.
+    bool receive(unsigned long now_ms);
+    /// @brief Handles a request forwarded by another controller, and acknowledges it.
+    void onForward(uint8_t node_id, uint8_t sequence, const Request& request);
+    /// @brief Handles an announcement.
+    void onAnnouncement(const ClusterProtocol::Announcement& announcement, const IPAddress& address, uint16_t port,
+        unsigned long now_ms);
+    /// @brief Derives the owners from the active peers, and updates the controller.
+    void updateOwners();
+    /// @brief Sends an announcement, if it is due.
+    void announce(unsigned long now_ms);
+    /// @brief Returns the active peer of a node id.
+    const Peer* peerOf(uint8_t node_id) const;
+    Peer* peerOf(uint8_t node_id);
+
+    /// @brief The maximum number of datagrams handled in one tick.
+    static const int max_packets_per_tick = 4;
+    /// @brief The maximum number of requests received while waiting for an acknowledgement.
+    static const std::size_t max_deferred = 4;
+
+    ShutterController& controller_;
+    Config config_;
+    WiFiUDP udp_;
+    std::array<Peer, max_peers> peers_;
+    /// @brief The owner of every shutter.
+    std::array<uint8_t, Shutter::Device::ALL> owners_ {};
+    /// @brief The time of the last announcement [ms].
+    unsigned long announced_ms_ = 0;
+    /// @brief The state snapshot version of the last announcement.
+    unsigned long announced_version_ = 0;
+    /// @brief True, if the owners changed since the last announcement.
+    bool owners_changed_ = true;
+    /// @brief The sequence number of the last forwarded request.
+    uint8_t forward_sequence_ = 0;
+    /// @brief The owner the acknowledgement is waited for from, no_owner if not forwarding.
+    uint8_t awaited_node_id_ = no_owner;
+    /// @brief True, if the awaited acknowledgement arrived.
+    bool acknowledged_ = false;
+    /// @brief The requests received while waiting for an acknowledgement, submitted in the next tick. The
+    /// controller is not re-entered from its own forwarder.
+    std::array<Request, max_deferred> deferred_;
+    std::size_t deferred_count_ = 0;
+    unsigned long forwarded_ = 0;
+    unsigned long forward_failures_ = 0;
+};
@@ -0,0 +1,44 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#pragma once
+
+#include <cstdint>
+
+/// @brief Struct containing the parameters of the coordination with the other controllers on the LAN.
+///
+/// Every controller announces the shutters in its RF range. A shutter is owned by the controller with the lowest
+/// node id reaching it, the others forward its commands there. Every controller needs a unique node id.
+struct ClusterParams
+{
+    /// @brief The node id of this controller, unique on the LAN, starting from 1.
+    static const uint8_t node_id = 1;
+    /// @brief The shutters in the RF range of this controller (bit n = Shutter::Device n).
+    static const uint8_t reachable_mask = 0b1111;
+    /// @brief The UDP port of the coordination, the announcements are broadcast to it.
+    static const uint16_t port = 5006;
+    /// @brief The time between two announcements, unless the state changes sooner. [ms]
+    static const unsigned long announce_period_ms = 1000;
+    /// @brief The shortest time between two announcements. [ms]
+    static const unsigned long min_announce_period_ms = 100;
+    /// @brief A controller not heard from for this time is considered gone, its shutters are taken over. [ms]
+    static const unsigned long peer_timeout_ms = 3500;
+    /// @brief The time to wait for the owner to acknowledge a forwarded request, before sending it again. The wait
+    /// blocks the control loop, only an owner gone silent lets it expire. [ms]
+    static const unsigned long forward_ack_timeout_ms = 10;
+    /// @brief The number of times a forwarded request is sent. Without an acknowledgement the owner is considered
+    /// gone, and the request is applied locally.
+    static const int forward_attempts = 3;
+};
@@ -0,0 +1,132 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "cluster_protocol.h"
+
+bool ClusterProtocol::decodeHeader(const uint8_t* data, std::size_t size, uint8_t& node_id, Type& type)
+{
+    if (size < header_size || data[0] != magic || data[1] != version)
+    {
+        return false;
+    }
+    if (data[2] != Type::ANNOUNCE && data[2] != Type::FORWARD && data[2] != Type::ACK)
+    {
+        return false;
+    }
+    type = static_cast<Type>(data[2]);
+    node_id = data[3];
+    return true;
+}
+
+std::size_t ClusterProtocol::encodeAnnouncement(const Announcement& announcement, uint8_t* buffer)
+{
+    buffer[0] = magic;
+    buffer[1] = version;
+    buffer[2] = Type::ANNOUNCE;
+    buffer[3] = announcement.node_id;
+    buffer[4] = announcement.reachable_mask;
+    buffer[5] = announcement.owned_mask;
+    for (int device = 0; device < Shutter::Device::ALL; ++device)
+    {
+        const auto& state = announcement.states[device];
+        buffer[6 + 2 * device] = state.position;
+        buffer[7 + 2 * device] = (state.calibrated ? 0x01 : 0x00) | (state.busy ? 0x02 : 0x00);
+    }
+    return announce_size;
+}
+
+bool ClusterProtocol::decodeAnnouncement(const uint8_t* data, std::size_t size, Announcement& announcement)
+{
+    if (size != announce_size || data[2] != Type::ANNOUNCE)
+    {
+        return false;
+    }
+    announcement.node_id = data[3];
+    announcement.reachable_mask = data[4];
+    announcement.owned_mask = data[5];
+    for (int device = 0; device < Shutter::Device::ALL; ++device)
+    {
+        auto& state = announcement.states[device];
+        state.position = data[6 + 2 * device] > 100 ? 100 : data[6 + 2 * device];
+        state.calibrated = data[7 + 2 * device] & 0x01;
+        state.busy = data[7 + 2 * device] & 0x02;
+    }
+    return true;
+}
+
+std::size_t ClusterProtocol::encodeForward(uint8_t node_id, uint8_t sequence, const Request& request, uint8_t* buffer)
+{
+    buffer[0] = magic;
+    buffer[1] = version;
+    buffer[2] = Type::FORWARD;
+    buffer[3] = node_id;
+    buffer[4] = static_cast<uint8_t>(request.type);
+    buffer[5] = static_cast<uint8_t>(request.device);
+    buffer[6] = static_cast<uint8_t>(request.instruction);
+    buffer[7] = static_cast<uint8_t>(request.position);
+    buffer[8] = static_cast<uint8_t>(request.scene_id);
+    buffer[9] = sequence;
+    for (int byte_index = 0; byte_index < 4; ++byte_index)
+    {
+        buffer[10 + byte_index] = static_cast<uint8_t>(request.request_id >> (8 * byte_index));
+    }
+    return forward_size;
+}
+
+bool ClusterProtocol::decodeForward(const uint8_t* data, std::size_t size, uint8_t& sequence, Request& request)
+{
+    if (size != forward_size || data[2] != Type::FORWARD)
+    {
+        return false;
+    }
+    if (data[4] > Request::Type::CALIBRATE || data[5] >= Shutter::Device::ALL || data[6] > Instruction::UNKNOWN ||
+        data[7] > 100)
+    {
+        return false;
+    }
+    request.type = static_cast<Request::Type>(data[4]);
+    request.device = static_cast<Shutter::Device>(data[5]);
+    request.instruction = static_cast<Instruction>(data[6]);
+    request.position = data[7];
+    request.scene_id = static_cast<int8_t>(data[8]);
+    sequence = data[9];
+    request.request_id = 0;
+    for (int byte_index = 0; byte_index < 4; ++byte_index)
+    {
+        request.request_id |= static_cast<uint32_t>(data[10 + byte_index]) << (8 * byte_index);
+    }
+    request.forwarded = true;
+    return true;
+}
+
+std::size_t ClusterProtocol::encodeAck(uint8_t node_id, uint8_t sequence, uint8_t* buffer)
+{
+    buffer[0] = magic;
+    buffer[1] = version;
+    buffer[2] = Type::ACK;
+    buffer[3] = node_id;
+    buffer[4] = sequence;
+    return ack_size;
+}
+
+bool ClusterProtocol::decodeAck(const uint8_t* data, std::size_t size, uint8_t& sequence)
+{
+    if (size != ack_size || data[2] != Type::ACK)
+    {
+        return false;
+    }
+    sequence = data[4];
+    return true;
+}
@@ -0,0 +1,120 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "request.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Struct describing the UDP protocol between the controllers.
+///
+/// Announcement datagram (6 + 2 * shutter count bytes), broadcast periodically and on state changes:
+///   [0] magic ('C')  [1] version  [2] type (ANNOUNCE)  [3] node id  [4] reachable mask  [5] owned mask
+///   then for every shutter: [position] [flags (bit 0: calibrated, bit 1: busy)], valid for the owned ones
+///
+/// Forward datagram (14 bytes), sent to the owner of the commanded shutter, repeated until acknowledged:
+///   [0] magic  [1] version  [2] type (FORWARD)  [3] node id  [4] request type  [5] device  [6] instruction
+///   [7] position  [8] scene id  [9] forward sequence number  [10..13] request id (little endian)
+///
+/// Acknowledgement datagram (5 bytes), sent back by the owner once the request is accepted:
+///   [0] magic  [1] version  [2] type (ACK)  [3] node id  [4] the acknowledged forward sequence number
+struct ClusterProtocol
+{
+    /// @brief Enum for the datagram types.
+    enum Type : uint8_t
+    {
+        ANNOUNCE = 1,
+        FORWARD = 2,
+        ACK = 3
+    };
+
+    /// @brief Struct encapsulating the state of one shutter in an announcement.
+    struct ShutterState
+    {
+        uint8_t position = 0;
+        bool calibrated = false;
+        bool busy = false;
+    };
+
+    /// @brief Struct encapsulating a decoded announcement.
+    struct Announcement
+    {
+        uint8_t node_id = 0;
+        uint8_t reachable_mask = 0;
+        uint8_t owned_mask = 0;
+        ShutterState states[Shutter::Device::ALL];
+    };
+
+    static const uint8_t magic = 'C';
+    static const uint8_t version = 2;
+    static const std::size_t header_size = 4;
+    static const std::size_t announce_size = 6 + 2 * Shutter::Device::ALL;
+    static const std::size_t forward_size = 14;
+    static const std::size_t ack_size = 5;
+    static const std::size_t max_size = announce_size > forward_size ? announce_size : forward_size;
+
+    /// @brief Returns the type of a datagram.
+    /// @param data The datagram.
+    /// @param size The size of the datagram.
+    /// @param node_id The node id of the sender.
+    /// @param type The type of the datagram.
+    /// @return True, if the datagram has a valid header.
+    static bool decodeHeader(const uint8_t* data, std::size_t size, uint8_t& node_id, Type& type);
+
+    /// @brief Encodes an announcement.
+    /// @param announcement The announcement.
+    /// @param buffer The output buffer of announce_size bytes.
+    /// @return The size of the announcement.
+    static std::size_t encodeAnnouncement(const Announcement& announcement, uint8_t* buffer);
+
+    /// @brief Decodes an announcement.
+    /// @param data The datagram.
+    /// @param size The size of the datagram.
+    /// @param announcement The decoded announcement.
+    /// @return True, if the datagram is a valid announcement.
+    static bool decodeAnnouncement(const uint8_t* data, std::size_t size, Announcement& announcement);
+
+    /// @brief Encodes a forwarded request.
+    /// @param node_id The node id of the sender.
+    /// @param sequence The forward sequence number of the sender.
+    /// @param request The request.
+    /// @param buffer The output buffer of forward_size bytes.
+    /// @return The size of the datagram.
+    static std::size_t encodeForward(uint8_t node_id, uint8_t sequence, const Request& request, uint8_t* buffer);
+
+    /// @brief Decodes a forwarded request.
+    /// @param data The datagram.
+    /// @param size The size of the datagram.
+    /// @param sequence The forward sequence number of the sender.
+    /// @param request The decoded request, marked as forwarded.
+    /// @return True, if the datagram is a valid forwarded request.
+    static bool decodeForward(const uint8_t* data, std::size_t size, uint8_t& sequence, Request& request);
+
+    /// @brief Encodes an acknowledgement.
+    /// @param node_id The node id of the sender.
+    /// @param sequence The acknowledged forward sequence number.
+    /// @param buffer The output buffer of ack_size bytes.
+    /// @return The size of the datagram.
+    static std::size_t encodeAck(uint8_t node_id, uint8_t sequence, uint8_t* buffer);
+
+    /// @brief Decodes an acknowledgement.
+    /// @param data The datagram.
+    /// @param size The size of the datagram.
+    /// @param sequence The acknowledged forward sequence number.
+    /// @return True, if the datagram is a valid acknowledgement.
+    static bool decodeAck(const uint8_t* data, std::size_t size, uint8_t& sequence);
+};
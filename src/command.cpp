@@ -13,6 +13,18 @@
 // ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "command.h"
+#include "command_queue.h"
+#include "memory_pool.h"
+
+#include <algorithm>
+
+namespace
+{
+    /// @brief The size of the largest command type.
+    constexpr std::size_t command_size = std::max({sizeof(RelativeCommand), sizeof(AbsoluteCommand), sizeof(CalibrationCommand)});
+    /// @brief The pool storing every command: a full queue for each shutter.
+    MemoryPool<command_size, 4 * CommandQueue::capacity> command_pool("commands");
+}
 
 Command::Command(int id, Type type):
     id_(id),
@@ -21,6 +33,21 @@ Command::Command(int id, Type type):
 {
 }
 
+void* Command::operator new(std::size_t size) noexcept
+{
+    return command_pool.allocate(size);
+}
+
+void Command::operator delete(void* ptr) noexcept
+{
+    command_pool.deallocate(ptr);
+}
+
+const MemoryStats& Command::memoryStats()
+{
+    return command_pool.stats();
+}
+
 Command::Type Command::getType() const
 {
     return type_;
@@ -78,6 +105,11 @@ RelativeCommand::RelativeCommand(int id, Instruction instruction):
     instruction_ = instruction;
 }
 
+int RelativeCommand::getTargetPosition() const
+{
+    return instruction_ == Instruction::DOWN ? 100 : 0;
+}
+
 AbsoluteCommand::AbsoluteCommand(int id, int target_position):
     Command(id, Type::ABSOLUTE),
     target_position_(target_position)
@@ -89,8 +121,13 @@ int AbsoluteCommand::getTargetPosition() const
     return target_position_;
 }
 
-CalibrationCommand::CalibrationCommand(int id):
+CalibrationCommand::CalibrationCommand(int id, Instruction instruction):
     Command(id, Type::CALIBRATE)
 {
-    instruction_ = Instruction::UP;
+    instruction_ = instruction == Instruction::DOWN ? Instruction::DOWN : Instruction::UP;
+}
+
+int CalibrationCommand::getTargetPosition() const
+{
+    return instruction_ == Instruction::DOWN ? 100 : 0;
 }
@@ -15,7 +15,9 @@
 #pragma once
 
 #include "instruction.h"
+#include "memory_stats.h"
 #include <array>
+#include <cstddef>
 
 /// @brief Class encapsulating a command instance.
 class Command
@@ -42,6 +44,18 @@ public:
     /// @param id The command identifier, shared across all shutters.
     /// @param type The command type.
     Command (int id, Type type);
+    virtual ~Command() = default;
+
+    /// @brief Allocates a command (of any derived type) from the static command pool.
+    /// @param size The size of the command instance.
+    /// @return Pointer to the storage, nullptr if the pool is exhausted.
+    static void* operator new(std::size_t size) noexcept;
+    /// @brief Returns a command's storage to the static command pool.
+    /// @param ptr Pointer to the storage.
+    static void operator delete(void* ptr) noexcept;
+    /// @brief Returns the allocation statistics of the command pool.
+    /// @return The allocation statistics.
+    static const MemoryStats& memoryStats();
 
     /// @brief Gets the command type.
     /// @return The command type.
@@ -90,6 +104,10 @@ public:
     /// @param id The command identifier.
     /// @param instruction The instruction of the relative command. 
     RelativeCommand(int id, Instruction instruction);
+
+    /// @brief Returns the end position the relative command moves towards.
+    /// @return 100 when moving down, 0 otherwise.
+    int getTargetPosition() const override;
 };
 
 /// @brief Class for an absolute command.
@@ -110,11 +128,16 @@ private:
     int target_position_ = 0;
 };
 
-/// @brief Class for a calibration command.
+/// @brief Class for a calibration command, moving the shutter fully to one of its end positions.
 class CalibrationCommand : public Command
 {
 public:
     /// @brief Constructor.
     /// @param id The command identifier.
-    CalibrationCommand(int id);
+    /// @param instruction The direction of the calibration: UP (top end position) or DOWN (bottom end position).
+    CalibrationCommand(int id, Instruction instruction = Instruction::UP);
+
+    /// @brief Returns the end position reached by the calibration.
+    /// @return 0 when calibrating upwards, 100 when calibrating downwards.
+    int getTargetPosition() const override;
 };
@@ -0,0 +1,111 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "command.h"
+
+#include <array>
+#include <cstddef>
+#include <memory>
+
+/// @brief Fixed-capacity FIFO of commands, replacing std::deque to avoid allocating queue nodes on the heap.
+class CommandQueue
+{
+public:
+    /// @brief The maximum number of commands in a queue.
+    static const std::size_t capacity = 8;
+
+    /// @brief Appends a command.
+    /// @param command Pointer to the command instance.
+    /// @return True, if the command was stored, false if the queue is full.
+    bool push_back(std::unique_ptr<Command> command)
+    {
+        if (full())
+        {
+            return false;
+        }
+        commands_[(head_ + size_) % capacity] = std::move(command);
+        ++size_;
+        return true;
+    }
+
+    /// @brief Destroys the oldest command.
+    void pop_front()
+    {
+        if (empty())
+        {
+            return;
+        }
+        commands_[head_].reset();
+        head_ = (head_ + 1) % capacity;
+        --size_;
+    }
+
+    /// @brief Destroys the newest commands, keeping the given number of oldest ones.
+    /// @param size The number of commands to keep.
+    void truncate(std::size_t size)
+    {
+        while (size_ > size)
+        {
+            commands_[(head_ + size_ - 1) % capacity].reset();
+            --size_;
+        }
+    }
+
+    /// @brief Returns the oldest command. The queue must not be empty.
+    /// @return Reference to the oldest command.
+    std::unique_ptr<Command>& front()
+    {
+        return commands_[head_];
+    }
+
+    /// @brief Destroys every command.
+    void clear()
+    {
+        while (!empty())
+        {
+            pop_front();
+        }
+    }
+
+    /// @brief Returns the number of commands.
+    /// @return The number of commands.
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+    /// @brief Returns if the queue is empty.
+    /// @return True, if the queue is empty.
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    /// @brief Returns if the queue is full.
+    /// @return True, if the queue is full.
+    bool full() const
+    {
+        return size_ == capacity;
+    }
+
+private:
+    /// @brief The command storage.
+    std::array<std::unique_ptr<Command>, capacity> commands_;
+    /// @brief The index of the oldest command.
+    std::size_t head_ = 0;
+    /// @brief The number of stored commands.
+    std::size_t size_ = 0;
+};
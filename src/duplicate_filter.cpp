@@ -0,0 +1,101 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "duplicate_filter.h"
+
+bool DuplicateFilter::duplicate(const Request& request, unsigned long now_ms)
+{
+    if (request.type == Request::Type::LOAD_SCENE)
+    {
+        return false;
+    }
+
+    const int argument = argumentOf(request);
+    const bool bare_stop =
+        request.request_id == 0 && request.type == Request::Type::RELATIVE && request.instruction == Instruction::STOP;
+    bool duplicate = false;
+    if (request.request_id != 0)
+    {
+        // A retry repeats the id together with the request, a reused id with another request is not a retry.
+        for (const auto& entry : entries_)
+        {
+            if (entry.used && entry.request_id == request.request_id && same(entry, request, argument) &&
+                now_ms - entry.time_ms < id_window_ms)
+            {
+                duplicate = true;
+                break;
+            }
+        }
+    }
+    else if (!bare_stop)
+    {
+        // Only a repetition of the latest request of the shutter is a duplicate: "up, stop, up" is not.
+        const Entry* latest = latestOf(request.device);
+        duplicate = latest && latest->request_id == 0 && same(*latest, request, argument) &&
+            now_ms - latest->time_ms < window_ms;
+    }
+    if (duplicate)
+    {
+        return true;
+    }
+
+    // A STOP is remembered too, it breaks the sequence of the identical requests.
+    auto& entry = entries_[next_];
+    next_ = (next_ + 1) % entries_.size();
+    entry.used = true;
+    entry.request_id = request.request_id;
+    entry.type = request.type;
+    entry.device = request.device;
+    entry.instruction = request.instruction;
+    entry.argument = argument;
+    entry.time_ms = now_ms;
+    return false;
+}
+
+const DuplicateFilter::Entry* DuplicateFilter::latestOf(Shutter::Device device) const
+{
+    // The entries are replaced round-robin, the newest one precedes next_.
+    for (std::size_t age = 1; age <= entries_.size(); ++age)
+    {
+        const auto& entry = entries_[(next_ + entries_.size() - age) % entries_.size()];
+        if (entry.used && entry.device == device)
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool DuplicateFilter::same(const Entry& entry, const Request& request, int argument)
+{
+    return entry.device == request.device && entry.type == request.type && entry.instruction == request.instruction &&
+        entry.argument == argument;
+}
+
+uint32_t DuplicateFilter::idOf(const char* key)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (; *key != '\0'; ++key)
+    {
+        hash = (hash ^ static_cast<unsigned char>(*key)) * 16777619u;
+    }
+    return hash != 0 ? hash : 1;
+}
+
+int DuplicateFilter::argumentOf(const Request& request)
+{
+    return request.type == Request::Type::RUN_SCENE ? request.scene_id : request.position;
+}
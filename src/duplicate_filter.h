@@ -0,0 +1,84 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "request.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Class suppressing the repeated requests (reloads, back navigation, prefetching, retransmissions).
+///
+/// A request is a duplicate of a recent identical request with the same id, or, without an id, of an identical
+/// latest request of the same shutter, very recently. A STOP without an id is never suppressed (it is rather a retry
+/// than a duplicate), but it is remembered: "up, stop, up" goes through.
+/// Only used from the control loop.
+class DuplicateFilter
+{
+public:
+    /// @brief The number of recent requests remembered.
+    static const std::size_t table_size = 8;
+    /// @brief The time an identical request without an id is suppressed [ms].
+    static const unsigned long window_ms = 2000;
+    /// @brief The time a request id is remembered [ms].
+    static const unsigned long id_window_ms = 30000;
+
+    /// @brief Checks a request, and remembers it if it is not a duplicate.
+    /// @param request The request.
+    /// @param now_ms The current time [ms].
+    /// @return True, if the request is a duplicate of a recent one.
+    bool duplicate(const Request& request, unsigned long now_ms);
+
+    /// @brief Returns the request id of a client supplied key.
+    /// @param key The key, e.g. the id parameter of a web request.
+    /// @return The request id, never 0 (no id).
+    static uint32_t idOf(const char* key);
+
+private:
+    /// @brief Struct encapsulating a remembered request.
+    struct Entry
+    {
+        bool used = false;
+        uint32_t request_id = 0;
+        Request::Type type = Request::Type::UNKNOWN;
+        Shutter::Device device = Shutter::Device::UNKNOWN_DEVICE;
+        Instruction instruction = Instruction::UNKNOWN;
+        /// @brief The position or the scene id.
+        int argument = 0;
+        unsigned long time_ms = 0;
+    };
+
+    /// @brief Returns the position or the scene id of a request.
+    static int argumentOf(const Request& request);
+
+    /// @brief Returns the latest remembered request of a shutter.
+    /// @param device The shutter device.
+    /// @return The entry, nullptr if there is none.
+    const Entry* latestOf(Shutter::Device device) const;
+
+    /// @brief Returns if a remembered request equals a request, apart from the id.
+    /// @param entry The remembered request.
+    /// @param request The request.
+    /// @param argument The position or the scene id of the request.
+    /// @return True, if the shutter, the type, the instruction and the argument are the same.
+    static bool same(const Entry& entry, const Request& request, int argument);
+
+    /// @brief The remembered requests, replaced round-robin.
+    std::array<Entry, table_size> entries_;
+    /// @brief The index of the next entry to replace.
+    std::size_t next_ = 0;
+};
@@ -0,0 +1,56 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include <Arduino.h>
+
+#include "event_trace.h"
+
+#include <array>
+
+static_assert(sizeof(EventTrace::Event) == 8, "The dump format requires 8 byte events");
+static_assert((EventTrace::capacity & (EventTrace::capacity - 1)) == 0, "The capacity must be a power of two");
+
+namespace
+{
+    /// @brief The ring buffer of the events.
+    std::array<EventTrace::Event, EventTrace::capacity> events;
+    /// @brief The number of recorded events, the next slot is its lower bits.
+    std::atomic<std::uint32_t> next_event {0};
+}
+
+void EventTrace::record(Type type, std::uint8_t device, std::uint16_t arg)
+{
+    // Claiming the slot is the only synchronization, a dump may see a slot which is being written.
+    auto& event = events[next_event.fetch_add(1, std::memory_order_relaxed) & (capacity - 1)];
+    event.time_us = micros();
+    event.type = type;
+    event.device = device;
+    event.arg = arg;
+}
+
+std::uint32_t EventTrace::recorded()
+{
+    return next_event.load(std::memory_order_relaxed);
+}
+
+std::uint32_t EventTrace::oldest(std::uint32_t recorded)
+{
+    return recorded < capacity ? 0 : recorded - capacity;
+}
+
+const EventTrace::Event& EventTrace::at(std::uint32_t sequence)
+{
+    return events[sequence & (capacity - 1)];
+}
@@ -0,0 +1,87 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Class recording timestamped events into an always-on ring buffer.
+///
+/// Recording stores 8 bytes and never blocks, the oldest events are overwritten. The events are dumped in a
+/// binary format by /api/trace, tools/trace_to_chrome.py converts a dump to the Chrome / Perfetto trace format.
+class EventTrace
+{
+public:
+    /// @brief Enum for the event type.
+    enum Type : std::uint8_t
+    {
+        /// @brief A request was received, the argument is the Request::Type.
+        REQUEST_RECEIVED,
+        /// @brief A command was queued for a shutter, the argument is the command id.
+        COMMAND_ENQUEUED,
+        /// @brief A frame repetition started, the argument is the instruction.
+        FRAME_START,
+        /// @brief A frame repetition ended, the argument is the instruction.
+        FRAME_END,
+        /// @brief A command was sent and is executing, the argument is the command id.
+        COMMAND_EXECUTING,
+        /// @brief A command was done, the argument is the command id.
+        COMMAND_DONE,
+        /// @brief A control tick started late, the argument is the time since the previous tick [ms].
+        TICK_OVERRUN
+    };
+
+    /// @brief Struct encapsulating one recorded event, dumped as is (little endian).
+    struct Event
+    {
+        /// @brief The time of the event [us], wraps around after ~71 minutes.
+        std::uint32_t time_us;
+        /// @brief The event type.
+        std::uint8_t type;
+        /// @brief The device id of the frame, or no_device.
+        std::uint8_t device;
+        /// @brief The type specific argument.
+        std::uint16_t arg;
+    };
+
+    /// @brief The number of events kept, a power of two.
+    static const std::size_t capacity = 256;
+    /// @brief The version of the dump format.
+    static const std::uint8_t format_version = 1;
+    /// @brief The device of the events not related to a device.
+    static const std::uint8_t no_device = 0xff;
+
+    /// @brief Records an event. May be called from the loop and from the async web server context.
+    /// @param type The event type.
+    /// @param device The device id, or no_device.
+    /// @param arg The type specific argument.
+    static void record(Type type, std::uint8_t device, std::uint16_t arg = 0);
+
+    /// @brief Returns the number of events recorded since boot.
+    /// @return The number of recorded events, including the overwritten ones.
+    static std::uint32_t recorded();
+
+    /// @brief Returns the sequence number of the oldest kept event.
+    /// @param recorded The number of recorded events, see recorded().
+    /// @return The sequence number of the oldest kept event.
+    static std::uint32_t oldest(std::uint32_t recorded);
+
+    /// @brief Returns a kept event.
+    /// @param sequence The sequence number of the event, from oldest() up to, not including recorded().
+    /// @return The event.
+    static const Event& at(std::uint32_t sequence);
+};
@@ -18,19 +18,36 @@
 #include <LittleFS.h>
 #include <ArduinoJson.h>
 
+#include "admission_control.h"
+#include "boot_profile.h"
+#include "cluster_node.h"
+#include "event_trace.h"
+#include "mqtt_client.h"
+#include "scratch_arena.h"
 #include "shutter_controller.h" 
+#include "udp_server.h"
+#include "web_api.h"
+#include "wifi_connector.h"
 #include "../credentials/credentials.h"
 
 // Define the macro to disable transmission, and to enable printing to Serial.
 // #define DEBUG
 
 const unsigned int TRANSMIT_PIN = 1;
+const uint16_t UDP_PORT = 5005;
 // Set web server port number to 80
 AsyncWebServer server(80);
 ShutterController controller(TRANSMIT_PIN);
-
-const char* command_param = "command";
-const char* shutter_scale_param = "shutter_scale";
+UdpServer udp_server(controller, UDP_PORT);
+MqttClient mqtt_client(controller);
+ClusterNode cluster(controller, {ClusterParams::node_id, ClusterParams::reachable_mask, ClusterParams::port,
+    IPAddress(255, 255, 255, 255), 1, ClusterParams::port});
+WifiConnector wifi_connector;
+BootProfile boot_profile;
+AdmissionControl admission;
+WebApi web_api(controller, admission);
+// Scratch memory of the request handlers, released after every request.
+ScratchArena scratch;
 
 const char* living_room_door_param = "living_room_door";
 const char* living_room_window_param = "living_room_window";
@@ -46,30 +63,175 @@ void notFound(AsyncWebServerRequest *request)
     request->send(404, "text/plain", "Not found");
 }
 
+size_t printMemoryStats(char* buffer, size_t size, const MemoryStats& stats)
+{
+    const int written = snprintf(buffer, size,
+        "\"%s\":{\"capacity\":%u,\"in_use\":%u,\"peak\":%u,\"allocations\":%lu,\"frees\":%lu,\"failures\":%lu}",
+        stats.name, static_cast<unsigned>(stats.capacity), static_cast<unsigned>(stats.in_use), static_cast<unsigned>(stats.peak),
+        stats.allocations, stats.frees, stats.failures);
+    return written < 0 ? 0 : std::min(static_cast<size_t>(written), size - 1);
+}
+
+void sendMemoryReport(AsyncWebServerRequest *request)
+{
+    char report[384];
+    size_t length = snprintf(report, sizeof(report),
+        "{\"heap\":{\"free\":%u,\"largest_free_block\":%u,\"fragmentation\":%u},",
+        static_cast<unsigned>(ESP.getFreeHeap()), static_cast<unsigned>(ESP.getMaxFreeBlockSize()),
+        static_cast<unsigned>(ESP.getHeapFragmentation()));
+    length += printMemoryStats(report + length, sizeof(report) - length, Command::memoryStats());
+    length += snprintf(report + length, sizeof(report) - length, ",");
+    length += printMemoryStats(report + length, sizeof(report) - length, scratch.stats());
+    snprintf(report + length, sizeof(report) - length, "}");
+    request->send(200, "application/json", report);
+}
+
+void sendMetrics(AsyncWebServerRequest *request)
+{
+    const auto& metrics = controller.metrics();
+    char report[256];
+    snprintf(report, sizeof(report),
+        "{\"broadcasts\":%lu,\"group_transmissions\":%lu,\"last_group_skew_us\":%lu,\"max_group_skew_us\":%lu,"
+        "\"suppressed_duplicates\":%lu,\"rate_limited\":%lu,\"overloaded\":%lu}",
+        metrics.broadcasts, metrics.group_transmissions, metrics.last_group_skew_us, metrics.max_group_skew_us,
+        metrics.suppressed_duplicates, admission.rateLimited(), admission.overloaded());
+    request->send(200, "application/json", report);
+}
+
+void sendBootProfile(AsyncWebServerRequest *request)
+{
+    char report[192];
+    size_t length = snprintf(report, sizeof(report), "{\"filesystem_ok\":%s,\"fast_wifi\":%s",
+        boot_profile.filesystem_ok ? "true" : "false", wifi_connector.fastConnect() ? "true" : "false");
+    for (int phase = 0; phase < BootProfile::PHASE_COUNT; ++phase)
+    {
+        if (!boot_profile.finished[phase] || length >= sizeof(report))
+        {
+            continue;
+        }
+        length += snprintf(report + length, sizeof(report) - length, ",\"%s_ms\":%lu",
+            BootProfile::name(static_cast<BootProfile::Phase>(phase)), boot_profile.phase_end_ms[phase]);
+    }
+    if (length < sizeof(report))
+    {
+        snprintf(report + length, sizeof(report) - length, "}");
+    }
+    request->send(200, "application/json", report);
+}
+
+void sendState(AsyncWebServerRequest *request)
+{
+    // Unchanged state: answered from the version alone.
+    char etag[StateSnapshot::etag_size];
+    StateSnapshot::formatEtag(controller.stateSnapshot().version(), etag);
+    if (request->hasHeader("If-None-Match") && request->getHeader("If-None-Match")->value() == etag)
+    {
+        request->send(304);
+        return;
+    }
+
+    char snapshot[StateSnapshot::buffer_size];
+    unsigned long version = 0;
+    controller.stateSnapshot().copy(snapshot, version);
+    StateSnapshot::formatEtag(version, etag);
+    AsyncWebServerResponse* response = request->beginResponse(200, "application/json", snapshot);
+    response->addHeader("ETag", etag);
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response);
+}
+
+void sendCluster(AsyncWebServerRequest *request)
+{
+    char report[224];
+    size_t length = snprintf(report, sizeof(report),
+        "{\"node_id\":%u,\"peers\":%u,\"forwarded\":%lu,\"forward_failures\":%lu,\"owners\":{",
+        static_cast<unsigned>(ClusterParams::node_id), static_cast<unsigned>(cluster.peers()), cluster.forwarded(),
+        cluster.forwardFailures());
+    for (int device = 0; device < Shutter::Device::ALL; ++device)
+    {
+        length += snprintf(report + length, sizeof(report) - length, "%s\"%s\":%u", device == 0 ? "" : ",",
+            ShutterController::deviceName(static_cast<Shutter::Device>(device)),
+            static_cast<unsigned>(cluster.ownerOf(static_cast<Shutter::Device>(device))));
+    }
+    snprintf(report + length, sizeof(report) - length, "}}");
+    request->send(200, "application/json", report);
+}
+
+void sendTrace(AsyncWebServerRequest *request)
+{
+    // Header: magic, format version, event size, event count, events recorded since boot (little endian).
+    const uint32_t recorded = EventTrace::recorded();
+    const uint32_t oldest = EventTrace::oldest(recorded);
+    const uint16_t count = recorded - oldest;
+    uint8_t header[12] = {'S', 'T', 'R', 'C', EventTrace::format_version, sizeof(EventTrace::Event)};
+    memcpy(header + 6, &count, sizeof(count));
+    memcpy(header + 8, &recorded, sizeof(recorded));
+
+    AsyncResponseStream* response = request->beginResponseStream("application/octet-stream");
+    response->write(header, sizeof(header));
+    for (uint32_t sequence = oldest; sequence != recorded; ++sequence)
+    {
+        response->write(reinterpret_cast<const uint8_t*>(&EventTrace::at(sequence)), sizeof(EventTrace::Event));
+    }
+    request->send(response);
+}
+
+void sendStatus(AsyncWebServerRequest *request, WebApi::Response response)
+{
+    switch (response)
+    {
+    case WebApi::Response::NOT_FOUND:
+        notFound(request);
+        break;
+    case WebApi::Response::BAD_REQUEST:
+        request->send(400);
+        break;
+    case WebApi::Response::TOO_LARGE:
+        request->send(413);
+        break;
+    case WebApi::Response::INBOX_FULL:
+        request->send(503);
+        break;
+    default:
+        request->send(200);
+        break;
+    }
+}
+
+void sendIndex(AsyncWebServerRequest *request)
+{
+    if (!boot_profile.filesystem_ok)
+    {
+        // Degraded mode: the commands still work, only the page is missing.
+        request->send(200, "text/plain", "OK (filesystem unavailable)");
+        return;
+    }
+    request->send(LittleFS, "/index.html", "text/html");
+}
 
 void setup() 
 {
 #ifdef DEBUG
     Serial.begin(9600);
 #endif
+    // The state versions restart on every boot, the ETags must not.
+    StateSnapshot::setBootNonce(ESP.random());
     DefaultHeaders::Instance().addHeader("Access-Control-Allow-Origin", "*");
     DefaultHeaders::Instance().addHeader("Access-Control-Allow-Methods", "GET, POST, PUT");
     DefaultHeaders::Instance().addHeader("Access-Control-Allow-Headers", "Content-Type");
 
-    if (!LittleFS.begin())
+    boot_profile.filesystem_ok = LittleFS.begin();
+    boot_profile.mark(BootProfile::Phase::FILESYSTEM, millis());
+    if (boot_profile.filesystem_ok)
     {
-        return;
+        controller.loadScenes();
     }
+    boot_profile.mark(BootProfile::Phase::SCENES, millis());
 
-    // Connect to Wi-Fi network with SSID and password
-    WiFi.begin(Credentials::ssid.c_str(), Credentials::password.c_str());
-    while (WiFi.status() != WL_CONNECTED) 
-    {
-        delay(500);
-    }
+    // Connect to Wi-Fi network with SSID and password in the background, loop() follows the connection.
+    wifi_connector.begin(Credentials::ssid.c_str(), Credentials::password.c_str(), boot_profile.filesystem_ok);
 
-    server.on("/", HTTP_GET, [](AsyncWebServerRequest *request)
-          { request->send(LittleFS, "/index.html", "text/html"); });
+    server.on("/", HTTP_GET, sendIndex);
 
     // Route for root index.css
     server.on("/style.css", HTTP_GET, [](AsyncWebServerRequest *request)
@@ -80,61 +242,119 @@ void setup()
     server.on("/index.js", HTTP_GET, [](AsyncWebServerRequest *request)
             { request->send(LittleFS, "/index.js", "text/javascript"); }); 
 
+    server.on("/api/memory", HTTP_GET, sendMemoryReport);
+    server.on("/api/metrics", HTTP_GET, sendMetrics);
+    server.on("/api/boot", HTTP_GET, sendBootProfile);
+    server.on("/api/state", HTTP_GET, sendState);
+    server.on("/api/trace", HTTP_GET, sendTrace);
+    server.on("/api/cluster", HTTP_GET, sendCluster);
+
     server.onRequestBody([](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
+    if (index != 0)
+    {
+        // The rest of a body which was already rejected.
+        return;
+    }
     if (request->url() == "/api/calibrate") 
     {
-        JsonDocument  ret;
-        deserializeJson(ret, data);
-        if (ret.isNull()) 
-        {
-            notFound(request);
-        }
-        if (!ret.containsKey("calibrate")) 
+        sendStatus(request, web_api.handleCalibrate(data, len, total, scratch));
+    }
+    else if (request->url() == "/api/scene")
+    {
+        WebApi::Response response = WebApi::Response::ACCEPTED;
         {
-            notFound(request);
+            JsonDocument ret(&scratch);
+            response = WebApi::parseBody(ret, data, len, total);
+            if (response == WebApi::Response::ACCEPTED && !ret.containsKey("id"))
+            {
+                response = WebApi::Response::BAD_REQUEST;
+            }
+            else if (response == WebApi::Response::ACCEPTED)
+            {
+                std::array<signed char, Shutter::Device::ALL> positions;
+                positions.fill(Scene::untouched);
+                for (const char* device_param : {living_room_door_param, living_room_window_param, bedroom_door_param, bedroom_window_param})
+                {
+                    if (ret.containsKey(device_param))
+                    {
+                        const int position = ret[device_param].as<int>();
+                        positions[ShutterController::decodeDevice(device_param)] = std::max(0, std::min(position, 100));
+                    }
+                }
+                if (!controller.saveScene(ret["id"].as<int>(), ret["name"].as<const char*>(), positions))
+                {
+                    response = WebApi::Response::NOT_FOUND;
+                }
+            }
         }
-        controller.createCalibrationCommand(ret["calibrate"]);
-        request->send(200);
+        scratch.reset();
+        sendStatus(request, response);
     }
     });
 
     // Send a GET request to <ESP_IP>/get?xy
     server.on("/get", HTTP_GET, [] (AsyncWebServerRequest *request) 
     {
-        if (request->hasParam(command_param)) 
+        std::array<WebApi::Param, WebApi::max_params> params;
+        const size_t count = std::min(request->params(), params.size());
+        for (size_t param_id = 0; param_id < count; param_id++)
         {
-            // Normal motion command
-            String command = request->getParam(command_param)->value();
-            controller.createRelativeCommand(command);
+            AsyncWebParameter* p = request->getParam(param_id);
+            params[param_id] = {&p->name(), &p->value()};
         }
-        else if (request->hasParam(shutter_scale_param))
+        const auto outcome = web_api.handleGet(params.data(), count, request->client()->remoteIP(), millis());
+        if (outcome.admitted)
         {
-        // Absolute motion command
-        String position_str = request->getParam(shutter_scale_param)->value();
-        const size_t param_num = request->params();
-        for (size_t param_id = 0; param_id < param_num; param_id++)
+            request->onDisconnect([]() { admission.release(); });
+        }
+        switch (outcome.response)
         {
-            AsyncWebParameter* p = request->getParam(param_id);
-            if (p->name() == shutter_scale_param)
-            {
-                continue;
-            }
-            controller.createAbsoluteCommand(p->name(), position_str);
-      }
-    }
-        request->send(LittleFS, "/index.html", "text/html");
+        case WebApi::Response::PAGE:
+            sendIndex(request);
+            break;
+        case WebApi::Response::STOPPED:
+            request->send(200, "text/plain", "OK");
+            break;
+        case WebApi::Response::RATE_LIMITED:
+            // An empty response, the cheapest answer.
+            request->send(429);
+            break;
+        case WebApi::Response::NOT_FOUND:
+        case WebApi::Response::BAD_REQUEST:
+            sendStatus(request, outcome.response);
+            break;
+        default:
+            request->send(503);
+            break;
+        }
     });
 
     server.onNotFound(notFound);
 
     server.begin();
+    udp_server.begin();
+    mqtt_client.begin();
+    cluster.begin();
+    boot_profile.mark(BootProfile::Phase::SERVICES, millis());
 }
 
 void loop()
 {
+    if (wifi_connector.execute() && !boot_profile.finished[BootProfile::Phase::WIFI])
+    {
+        boot_profile.mark(BootProfile::Phase::WIFI, millis());
+    }
+    udp_server.execute();
+    mqtt_client.execute();
+    cluster.execute();
     const auto time_ms = millis();
     if (time_ms - prev_exec_time_ms > exec_period_ms)
     {
+        if (prev_exec_time_ms != 0 && time_ms - prev_exec_time_ms > 2 * exec_period_ms)
+        {
+            // Blocked by a transmission or the network stack for more than a tick.
+            EventTrace::record(EventTrace::Type::TICK_OVERRUN, EventTrace::no_device, time_ms - prev_exec_time_ms);
+        }
         controller.execute();
         prev_exec_time_ms = time_ms;
     }
@@ -0,0 +1,92 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "memory_stats.h"
+
+#include <array>
+#include <cstddef>
+
+/// @brief Statically allocated pool of equally sized memory blocks.
+/// @tparam BlockSize The size of one block in bytes.
+/// @tparam BlockCount The number of blocks.
+template <std::size_t BlockSize, std::size_t BlockCount>
+class MemoryPool
+{
+public:
+    /// @brief Constructor.
+    /// @param name The name of the pool, used in the reports.
+    MemoryPool(const char* name) : stats_(name, BlockSize * BlockCount)
+    {
+        for (std::size_t i = 0; i + 1 < BlockCount; ++i)
+        {
+            blocks_[i].next = &blocks_[i + 1];
+        }
+        blocks_[BlockCount - 1].next = nullptr;
+        free_list_ = &blocks_[0];
+    }
+
+    /// @brief Takes a block from the pool.
+    /// @param size The requested size, at most BlockSize.
+    /// @return Pointer to the block, nullptr if the pool is exhausted.
+    void* allocate(std::size_t size)
+    {
+        if (size > BlockSize || free_list_ == nullptr)
+        {
+            stats_.recordFailure();
+            return nullptr;
+        }
+        Block* block = free_list_;
+        free_list_ = block->next;
+        stats_.recordAllocation(BlockSize);
+        return block->storage;
+    }
+
+    /// @brief Returns a block to the pool.
+    /// @param ptr Pointer to a block taken from this pool, or nullptr.
+    void deallocate(void* ptr)
+    {
+        if (ptr == nullptr)
+        {
+            return;
+        }
+        Block* block = static_cast<Block*>(ptr);
+        block->next = free_list_;
+        free_list_ = block;
+        stats_.recordFree(BlockSize);
+    }
+
+    /// @brief Returns the allocation statistics of the pool.
+    /// @return The allocation statistics.
+    const MemoryStats& stats() const
+    {
+        return stats_;
+    }
+
+private:
+    /// @brief A block, either linked into the free list or holding an object.
+    union Block
+    {
+        Block* next;
+        alignas(std::max_align_t) unsigned char storage[BlockSize];
+    };
+
+    /// @brief The block storage.
+    std::array<Block, BlockCount> blocks_;
+    /// @brief The first free block.
+    Block* free_list_ = nullptr;
+    /// @brief The allocation statistics.
+    MemoryStats stats_;
+};
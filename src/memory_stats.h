@@ -0,0 +1,67 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+
+/// @brief Struct collecting the allocation statistics of one memory subsystem.
+struct MemoryStats
+{
+    /// @brief Constructor.
+    /// @param name The name of the subsystem, used in the reports.
+    /// @param capacity The number of bytes reserved for the subsystem.
+    MemoryStats(const char* name, std::size_t capacity) : name(name), capacity(capacity) {}
+
+    /// @brief Records a successful allocation.
+    /// @param bytes The allocated size.
+    void recordAllocation(std::size_t bytes)
+    {
+        ++allocations;
+        in_use += bytes;
+        if (in_use > peak)
+        {
+            peak = in_use;
+        }
+    }
+
+    /// @brief Records a release.
+    /// @param bytes The released size.
+    void recordFree(std::size_t bytes)
+    {
+        ++frees;
+        in_use -= bytes;
+    }
+
+    /// @brief Records an allocation that could not be served.
+    void recordFailure()
+    {
+        ++failures;
+    }
+
+    /// @brief The name of the subsystem.
+    const char* name;
+    /// @brief The number of bytes reserved for the subsystem.
+    std::size_t capacity;
+    /// @brief The number of bytes currently in use.
+    std::size_t in_use = 0;
+    /// @brief The highest number of bytes in use since boot.
+    std::size_t peak = 0;
+    /// @brief The number of successful allocations since boot.
+    unsigned long allocations = 0;
+    /// @brief The number of releases since boot.
+    unsigned long frees = 0;
+    /// @brief The number of failed allocations since boot.
+    unsigned long failures = 0;
+};
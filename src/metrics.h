@@ -0,0 +1,42 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+/// @brief Struct collecting the runtime metrics of the controller.
+struct Metrics
+{
+    /// @brief Records a transmission commanding several devices with separate, interleaved frames.
+    /// @param skew_us The time between the first repetition of the first and the last frame [us].
+    void recordGroupTransmission(unsigned long skew_us)
+    {
+        ++group_transmissions;
+        last_group_skew_us = skew_us;
+        if (skew_us > max_group_skew_us)
+        {
+            max_group_skew_us = skew_us;
+        }
+    }
+
+    /// @brief The number of group transmissions since boot.
+    unsigned long group_transmissions = 0;
+    /// @brief The number of broadcast frames since boot.
+    unsigned long broadcasts = 0;
+    /// @brief The start skew of the last group transmission [us].
+    unsigned long last_group_skew_us = 0;
+    /// @brief The highest start skew of a group transmission since boot [us].
+    unsigned long max_group_skew_us = 0;
+    /// @brief The number of duplicate requests suppressed since boot.
+    unsigned long suppressed_duplicates = 0;
+};
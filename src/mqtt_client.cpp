@@ -0,0 +1,206 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "mqtt_client.h"
+#include "mqtt_params.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    /// @brief Returns if a payload equals a string.
+    bool payloadEquals(const uint8_t* payload, unsigned int length, const char* str)
+    {
+        return strlen(str) == length && memcmp(payload, str, length) == 0;
+    }
+
+    /// @brief Decodes a position (0..100) from a payload.
+    bool decodePosition(const uint8_t* payload, unsigned int length, int& position)
+    {
+        if (length == 0 || length > 3)
+        {
+            return false;
+        }
+        position = 0;
+        for (unsigned int i = 0; i < length; ++i)
+        {
+            if (payload[i] < '0' || payload[i] > '9')
+            {
+                return false;
+            }
+            position = position * 10 + (payload[i] - '0');
+        }
+        return position <= 100;
+    }
+}
+
+MqttClient::MqttClient(ShutterController& controller):
+    controller_(controller),
+    client_(wifi_client_)
+{
+}
+
+void MqttClient::begin()
+{
+    client_.setServer(MqttParams::broker, MqttParams::port);
+    client_.setKeepAlive(MqttParams::keep_alive_s);
+    client_.setSocketTimeout(MqttParams::socket_timeout_s);
+    // The default TCP connect timeout is seconds long, the broker is on the local network.
+    wifi_client_.setTimeout(MqttParams::connect_timeout_ms);
+    client_.setCallback([this](char* topic, uint8_t* payload, unsigned int length) { onMessage(topic, payload, length); });
+}
+
+void MqttClient::connect()
+{
+    if (millis() - last_attempt_ms_ < reconnect_period_ms_)
+    {
+        return;
+    }
+    for (int device = 0; device < Shutter::Device::ALL; ++device)
+    {
+        if (controller_.getShutter(static_cast<Shutter::Device>(device)).busy())
+        {
+            // A blocked loop would delay the STOP ending a motion.
+            return;
+        }
+    }
+
+    char topic[64];
+    snprintf(topic, sizeof(topic), "%s/status", MqttParams::topic_prefix);
+    const bool connected = client_.connect(MqttParams::client_id, topic, 1, true, "offline");
+    // The backoff is measured from the end of the attempt, which may have taken up to the timeouts.
+    last_attempt_ms_ = millis();
+    if (!connected)
+    {
+        reconnect_period_ms_ = reconnect_period_ms_ == 0 ? MqttParams::min_reconnect_period_ms :
+            std::min(2 * reconnect_period_ms_, MqttParams::max_reconnect_period_ms);
+        return;
+    }
+    reconnect_period_ms_ = MqttParams::min_reconnect_period_ms;
+    client_.publish(topic, "online", true);
+    snprintf(topic, sizeof(topic), "%s/+/set", MqttParams::topic_prefix);
+    client_.subscribe(topic);
+
+    // The broker may have lost the retained states, publish everything again.
+    published_.fill(PublishedState());
+}
+
+void MqttClient::onMessage(const char* topic, const uint8_t* payload, unsigned int length)
+{
+    // <prefix>/<shutter>/set
+    const auto prefix_length = strlen(MqttParams::topic_prefix);
+    if (strncmp(topic, MqttParams::topic_prefix, prefix_length) != 0 || topic[prefix_length] != '/')
+    {
+        return;
+    }
+    const char* device_name = topic + prefix_length + 1;
+
+    Request request;
+    for (int device = 0; device < Shutter::Device::ALL; ++device)
+    {
+        const char* name = ShutterController::deviceName(static_cast<Shutter::Device>(device));
+        const auto name_length = strlen(name);
+        if (strncmp(device_name, name, name_length) == 0 && strcmp(device_name + name_length, "/set") == 0)
+        {
+            request.device = static_cast<Shutter::Device>(device);
+            break;
+        }
+    }
+    if (request.device == Shutter::Device::UNKNOWN_DEVICE)
+    {
+        return;
+    }
+
+    int position = 0;
+    if (payloadEquals(payload, length, "up"))
+    {
+        request.type = Request::Type::RELATIVE;
+        request.instruction = Instruction::UP;
+    }
+    else if (payloadEquals(payload, length, "down"))
+    {
+        request.type = Request::Type::RELATIVE;
+        request.instruction = Instruction::DOWN;
+    }
+    else if (payloadEquals(payload, length, "stop"))
+    {
+        request.type = Request::Type::RELATIVE;
+        request.instruction = Instruction::STOP;
+    }
+    else if (payloadEquals(payload, length, "calibrate"))
+    {
+        request.type = Request::Type::CALIBRATE;
+    }
+    else if (decodePosition(payload, length, position))
+    {
+        request.type = Request::Type::ABSOLUTE;
+        request.position = position;
+    }
+    else
+    {
+        return;
+    }
+    controller_.submit(request);
+}
+
+void MqttClient::publishChanges()
+{
+    char topic[64];
+    char value[8];
+    for (int device = 0; device < Shutter::Device::ALL; ++device)
+    {
+        const auto& shutter = controller_.getShutter(static_cast<Shutter::Device>(device));
+        const char* name = ShutterController::deviceName(static_cast<Shutter::Device>(device));
+        auto& published = published_[device];
+
+        const int calibrated = shutter.calibrated() ? 1 : 0;
+        if (calibrated != published.calibrated)
+        {
+            snprintf(topic, sizeof(topic), "%s/%s/calibrated", MqttParams::topic_prefix, name);
+            if (client_.publish(topic, calibrated ? "true" : "false", true))
+            {
+                published.calibrated = calibrated;
+            }
+        }
+        if (shutter.position() != published.position)
+        {
+            snprintf(topic, sizeof(topic), "%s/%s/position", MqttParams::topic_prefix, name);
+            snprintf(value, sizeof(value), "%d", shutter.position());
+            if (client_.publish(topic, value, true))
+            {
+                published.position = shutter.position();
+            }
+        }
+    }
+}
+
+void MqttClient::execute()
+{
+    if (!client_.connected())
+    {
+        if (WiFi.status() != WL_CONNECTED)
+        {
+            return;
+        }
+        connect();
+        if (!client_.connected())
+        {
+            return;
+        }
+    }
+    client_.loop();
+    publishChanges();
+}
@@ -0,0 +1,72 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "shutter_controller.h"
+
+#include <ESP8266WiFi.h>
+#include <PubSubClient.h>
+#include <array>
+
+/// @brief Class keeping a persistent connection to an MQTT broker.
+///
+/// Subscribes to <prefix>/<shutter>/set (payload: "up", "down", "stop", "calibrate" or a position 0..100),
+/// and publishes the retained <prefix>/<shutter>/position and <prefix>/<shutter>/calibrated states when they change.
+/// Polled from the control loop, so the commands are applied to the controller directly.
+class MqttClient
+{
+public:
+    /// @brief Constructor.
+    /// @param controller The controller to command.
+    MqttClient(ShutterController& controller);
+
+    /// @brief Configures the client. The connection is established by execute().
+    void begin();
+
+    /// @brief Keeps the connection alive, handles the received commands and publishes the changed states.
+    void execute();
+
+private:
+    /// @brief Struct storing the last published state of a shutter.
+    struct PublishedState
+    {
+        int position = -1;
+        int calibrated = -1;
+    };
+
+    /// @brief Tries to (re)connect to the broker, with an exponential backoff after the failed attempts.
+    /// The attempt blocks, so it is deferred while a shutter has commands to execute.
+    void connect();
+    /// @brief Handles a received message.
+    /// @param topic The topic of the message.
+    /// @param payload The payload, not null terminated.
+    /// @param length The length of the payload.
+    void onMessage(const char* topic, const uint8_t* payload, unsigned int length);
+    /// @brief Publishes the states that changed since the last publication.
+    void publishChanges();
+
+    /// @brief The controller to command.
+    ShutterController& controller_;
+    /// @brief The TCP connection.
+    WiFiClient wifi_client_;
+    /// @brief The MQTT client.
+    PubSubClient client_;
+    /// @brief The end of the last failed connection attempt. [ms]
+    unsigned long last_attempt_ms_ = 0;
+    /// @brief The time to wait after the last failed attempt, 0 before the first attempt. [ms]
+    unsigned long reconnect_period_ms_ = 0;
+    /// @brief The last published state of every shutter.
+    std::array<PublishedState, Shutter::Device::ALL> published_;
+};
@@ -0,0 +1,41 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+
+/// @brief Struct containing the parameters of the MQTT connection.
+struct MqttParams
+{
+    /// @brief The address of the (local) broker.
+    static constexpr const char* broker = "192.168.1.2";
+    /// @brief The port of the broker.
+    static const uint16_t port = 1883;
+    /// @brief The client identifier.
+    static constexpr const char* client_id = "home_shutter_controller";
+    /// @brief The prefix of every topic: <prefix>/<shutter>/set, <prefix>/<shutter>/position, ...
+    static constexpr const char* topic_prefix = "shutters";
+    /// @brief The time between the end of a failed connection attempt and the next one, doubled after every
+    /// failure. [ms]
+    static const unsigned long min_reconnect_period_ms = 2000;
+    /// @brief The longest time between two connection attempts. [ms]
+    static const unsigned long max_reconnect_period_ms = 120000;
+    /// @brief The keep alive interval. [s]
+    static const uint16_t keep_alive_s = 30;
+    /// @brief The timeout of the TCP connection to the (local) broker, the attempt blocks the control loop. [ms]
+    static const uint16_t connect_timeout_ms = 250;
+    /// @brief The socket timeout of a connection attempt, the wait for the CONNACK. [s]
+    static const uint16_t socket_timeout_s = 1;
+};
@@ -0,0 +1,50 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "instruction.h"
+#include "shutter.h"
+
+#include <cstdint>
+
+/// @brief Struct encapsulating an already decoded external request, handed over to the control loop.
+struct Request
+{
+    /// @brief Enum for the request type.
+    enum Type
+    {
+        RELATIVE,
+        ABSOLUTE,
+        CALIBRATE,
+        RUN_SCENE,
+        LOAD_SCENE,
+        UNKNOWN
+    };
+
+    /// @brief The type of the request.
+    Type type = Type::UNKNOWN;
+    /// @brief The commanded device.
+    Shutter::Device device = Shutter::Device::UNKNOWN_DEVICE;
+    /// @brief The instruction of a relative command.
+    Instruction instruction = Instruction::UNKNOWN;
+    /// @brief The target position of an absolute command (0 = top, 100 = bottom).
+    int position = 0;
+    /// @brief The scene identifier of a scene request.
+    int scene_id = -1;
+    /// @brief The client supplied id of the request, repeated by the retries of the same request (0: no id).
+    uint32_t request_id = 0;
+    /// @brief True, if the request was forwarded by another controller, it is never forwarded again.
+    bool forwarded = false;
+};
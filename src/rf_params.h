@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <array>
+
 /// @brief Struct containing the parameters for the RF communication.
 struct RFParams
 {
@@ -49,3 +51,12 @@ struct RFParams
     /// @brief The number of transmitting the same command.
     static const int number_of_transmissions = 5;
 };
+
+/// @brief Struct containing the framing of the RF messages: the header and the instruction codes.
+struct RFFraming
+{
+    /// @brief The static message header, which identifies the shutter's receivers.
+    static constexpr std::array<unsigned char, 3> header {0b11001011, 0b01111010, 0b01010001};
+    /// @brief The instruction codes, indexed by the instruction (UP, DOWN, STOP).
+    static constexpr std::array<unsigned char, 3> instructions {0b00010001, 0b00110011, 0b01010101};
+};
@@ -0,0 +1,114 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "instruction.h"
+#include "rf_params.h"
+
+/// @brief Compile-time RF protocol generating the frames of one shutter brand.
+///
+/// Every timing and framing value is a constant of the traits, so each protocol gets its own frame generator
+/// with the bit timings selected by table lookup instead of branches.
+/// @tparam Timing The timing traits, see RFParams.
+/// @tparam Framing The framing traits, see RFFraming.
+template <typename Timing, typename Framing>
+struct RFProtocol
+{
+    /// @brief The number of repetitions of a frame.
+    static const int number_of_transmissions = Timing::number_of_transmissions;
+
+    /// @brief Sends a single repetition of a frame, followed by the gap between the repetitions.
+    /// @param pin The transmit pin.
+    /// @param device_id The commanded device's id.
+    /// @param instruction The instruction sent, UP, DOWN or STOP.
+    static void sendFrame(int pin, unsigned char device_id, Instruction instruction)
+    {
+        sendPulse(pin, Timing::sync_on, Timing::sync_off);
+        for (auto header_word : Framing::header)
+        {
+            sendWord(pin, header_word);
+        }
+        sendWord(pin, device_id);
+        sendWord(pin, Framing::instructions[instruction]);
+        delayMicroseconds(Timing::delay_between_packets_send);
+    }
+
+private:
+    /// @brief Sends a word, most significant bit first.
+    /// @param pin The transmit pin.
+    /// @param word The word.
+    static void sendWord(int pin, unsigned char word)
+    {
+        static constexpr int high_us[2] = {Timing::zero_high_send, Timing::one_high_send};
+        static constexpr int low_us[2] = {Timing::zero_low_send, Timing::one_low_send};
+        for (int bit_index = 7; bit_index >= 0; --bit_index)
+        {
+            const unsigned char bit = (word >> bit_index) & 1;
+            sendPulse(pin, high_us[bit], low_us[bit]);
+        }
+    }
+
+    /// @brief Sends a high, then a low level.
+    /// @param pin The transmit pin.
+    /// @param high_us The duration of the high level [us].
+    /// @param low_us The duration of the low level [us].
+    static void sendPulse(int pin, int high_us, int low_us)
+    {
+        digitalWrite(pin, HIGH);
+        delayMicroseconds(high_us);
+        digitalWrite(pin, LOW);
+        delayMicroseconds(low_us);
+    }
+};
+
+/// @brief Struct listing the RF protocols the shutters can be bound to, see ShutterParams.
+///
+/// Adding a brand: define its timing and framing traits, add an id and its entry in rf_protocol.cpp.
+struct RFProtocols
+{
+    /// @brief Enum for the protocol identifiers.
+    enum Id : unsigned char
+    {
+        /// @brief The protocol of RFParams and RFFraming.
+        STANDARD,
+        COUNT
+    };
+
+    /// @brief Struct encapsulating the frame generator of a protocol.
+    struct Entry
+    {
+        /// @brief Sends a single repetition of a frame.
+        void (*send_frame)(int pin, unsigned char device_id, Instruction instruction);
+        /// @brief The number of repetitions of a frame.
+        int number_of_transmissions;
+    };
+
+    /// @brief Returns the frame generator of a protocol.
+    /// @param id The protocol identifier, less than COUNT.
+    /// @return The frame generator.
+    static const Entry& get(Id id);
+
+    /// @brief Returns the entry of a protocol type.
+    /// @tparam Protocol The RFProtocol specialization.
+    /// @return The entry.
+    template <typename Protocol>
+    static constexpr Entry entry()
+    {
+        return Entry {&Protocol::sendFrame, Protocol::number_of_transmissions};
+    }
+};
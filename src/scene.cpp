@@ -0,0 +1,233 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "scene.h"
+
+#include <LittleFS.h>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    /// @brief Returns the file name of a persisted scene.
+    void scenePath(int id, char* path, std::size_t size)
+    {
+        snprintf(path, size, "/scene_%d.bin", id);
+    }
+}
+
+Scene::Scene()
+{
+    positions_.fill(untouched);
+}
+
+Scene::Scene(const char* name, const std::array<signed char, Shutter::Device::ALL>& positions):
+    positions_(positions)
+{
+    if (name != nullptr)
+    {
+        strncpy(name_, name, max_name_length);
+    }
+    compile();
+}
+
+bool Scene::valid() const
+{
+    return plan_.size > 0;
+}
+
+const char* Scene::getName() const
+{
+    return name_;
+}
+
+signed char Scene::getPosition(Shutter::Device device) const
+{
+    return positions_[device];
+}
+
+const TransmitPlan& Scene::getPlan() const
+{
+    return plan_;
+}
+
+unsigned char Scene::maskOf(signed char position) const
+{
+    unsigned char mask = 0;
+    for (int device = 0; device < Shutter::Device::ALL; ++device)
+    {
+        if (positions_[device] == position)
+        {
+            mask |= 1 << device;
+        }
+    }
+    return mask;
+}
+
+void Scene::compile()
+{
+    plan_.size = 0;
+    const unsigned char all_mask = (1 << Shutter::Device::ALL) - 1;
+
+    // Full travels first: they need no timing, so they can be sent right away, and if every shutter
+    // shares the same end position, a single broadcast frame moves all of them.
+    for (const signed char end_position : {0, 100})
+    {
+        const auto mask = maskOf(end_position);
+        if (mask == 0)
+        {
+            continue;
+        }
+        auto& step = plan_.steps[plan_.size++];
+        step.kind = mask == all_mask ? TransmitStep::Kind::BROADCAST : TransmitStep::Kind::FRAME;
+        step.device_mask = mask;
+        step.instruction = end_position == 0 ? Instruction::UP : Instruction::DOWN;
+    }
+
+    // Intermediate positions, one step per distinct position.
+    unsigned char planned_mask = 0;
+    for (int device = 0; device < Shutter::Device::ALL; ++device)
+    {
+        const auto position = positions_[device];
+        if (position <= 0 || position >= 100 || (planned_mask & (1 << device)))
+        {
+            continue;
+        }
+        auto& step = plan_.steps[plan_.size++];
+        step.kind = TransmitStep::Kind::ABSOLUTE;
+        step.device_mask = maskOf(position);
+        step.position = position;
+        planned_mask |= step.device_mask;
+    }
+}
+
+void Scene::serialize(unsigned char* buffer) const
+{
+    *buffer++ = format_version_;
+    memcpy(buffer, name_, sizeof(name_));
+    buffer += sizeof(name_);
+    for (const auto position : positions_)
+    {
+        *buffer++ = static_cast<unsigned char>(position);
+    }
+    *buffer++ = plan_.size;
+    for (const auto& step : plan_.steps)
+    {
+        *buffer++ = step.kind;
+        *buffer++ = step.device_mask;
+        *buffer++ = static_cast<unsigned char>(step.instruction);
+        *buffer++ = step.position;
+    }
+}
+
+bool Scene::deserialize(const unsigned char* buffer, std::size_t size)
+{
+    if (size != serialized_size || *buffer++ != format_version_)
+    {
+        return false;
+    }
+    memcpy(name_, buffer, sizeof(name_));
+    name_[max_name_length] = '\0';
+    buffer += sizeof(name_);
+    for (auto& position : positions_)
+    {
+        position = static_cast<signed char>(*buffer++);
+    }
+    plan_.size = *buffer++;
+    if (plan_.size > plan_.steps.size())
+    {
+        plan_.size = 0;
+        return false;
+    }
+    for (auto& step : plan_.steps)
+    {
+        step.kind = static_cast<TransmitStep::Kind>(*buffer++);
+        step.device_mask = *buffer++;
+        step.instruction = static_cast<Instruction>(*buffer++);
+        step.position = *buffer++;
+    }
+    return true;
+}
+
+void SceneStore::loadAll()
+{
+    for (int id = 0; id < capacity; ++id)
+    {
+        load(id);
+    }
+}
+
+void SceneStore::load(int id)
+{
+    if (id < 0 || id >= capacity)
+    {
+        return;
+    }
+    scenes_[id] = Scene();
+
+    char path[24];
+    scenePath(id, path, sizeof(path));
+    if (!LittleFS.exists(path))
+    {
+        return;
+    }
+    File file = LittleFS.open(path, "r");
+    if (!file)
+    {
+        return;
+    }
+    unsigned char buffer[Scene::serialized_size];
+    const auto size = file.read(buffer, sizeof(buffer));
+    file.close();
+
+    Scene scene;
+    if (scene.deserialize(buffer, size))
+    {
+        scenes_[id] = scene;
+    }
+}
+
+const Scene* SceneStore::get(int id) const
+{
+    if (id < 0 || id >= capacity || !scenes_[id].valid())
+    {
+        return nullptr;
+    }
+    return &scenes_[id];
+}
+
+bool SceneStore::persist(int id, const Scene& scene)
+{
+    if (id < 0 || id >= capacity)
+    {
+        return false;
+    }
+    char path[24];
+    scenePath(id, path, sizeof(path));
+    if (!scene.valid())
+    {
+        return !LittleFS.exists(path) || LittleFS.remove(path);
+    }
+
+    File file = LittleFS.open(path, "w");
+    if (!file)
+    {
+        return false;
+    }
+    unsigned char buffer[Scene::serialized_size];
+    scene.serialize(buffer);
+    const auto written = file.write(buffer, sizeof(buffer));
+    file.close();
+    return written == sizeof(buffer);
+}
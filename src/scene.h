@@ -0,0 +1,147 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "instruction.h"
+#include "shutter.h"
+
+#include <array>
+#include <cstddef>
+
+/// @brief Struct encapsulating one step of a scene's precompiled transmit plan.
+struct TransmitStep
+{
+    /// @brief Enum for the kind of a step.
+    enum Kind : unsigned char
+    {
+        /// @brief One frame to the broadcast device id, moving every shutter fully up or down.
+        BROADCAST,
+        /// @brief One frame per device in the mask, moving the shutters fully up or down.
+        FRAME,
+        /// @brief An absolute move of every device in the mask to the same intermediate position.
+        ABSOLUTE
+    };
+
+    /// @brief The kind of the step.
+    Kind kind = FRAME;
+    /// @brief The commanded devices, one bit per Shutter::Device.
+    unsigned char device_mask = 0;
+    /// @brief The instruction of a BROADCAST or FRAME step.
+    Instruction instruction = Instruction::UNKNOWN;
+    /// @brief The target position of an ABSOLUTE step.
+    unsigned char position = 0;
+};
+
+/// @brief Struct encapsulating the ordered transmit plan of a scene.
+struct TransmitPlan
+{
+    /// @brief The steps, every device appears in at most one of them.
+    std::array<TransmitStep, Shutter::Device::ALL> steps;
+    /// @brief The number of valid steps.
+    unsigned char size = 0;
+
+    const TransmitStep* begin() const { return steps.data(); }
+    const TransmitStep* end() const { return steps.data() + size; }
+};
+
+/// @brief Class encapsulating a named scene: a target position for some of the shutters.
+class Scene
+{
+public:
+    /// @brief The position value of a shutter not affected by the scene.
+    static const signed char untouched = -1;
+    /// @brief The maximum length of a scene's name.
+    static const std::size_t max_name_length = 15;
+
+    /// @brief Default constructor, creates an empty scene.
+    Scene();
+
+    /// @brief Constructor, compiles the transmit plan of the scene.
+    /// @param name The name of the scene, truncated to max_name_length characters.
+    /// @param positions The target position of each shutter (0 = top, 100 = bottom), or untouched.
+    Scene(const char* name, const std::array<signed char, Shutter::Device::ALL>& positions);
+
+    /// @brief Returns if the scene commands any shutter.
+    /// @return True, if the scene's plan is not empty.
+    bool valid() const;
+    /// @brief Returns the name of the scene.
+    /// @return The name of the scene.
+    const char* getName() const;
+    /// @brief Returns the target position of a shutter.
+    /// @param device The shutter device.
+    /// @return The target position, or untouched.
+    signed char getPosition(Shutter::Device device) const;
+    /// @brief Returns the precompiled transmit plan.
+    /// @return The transmit plan.
+    const TransmitPlan& getPlan() const;
+
+    /// @brief Serializes the scene (including its plan) into a buffer.
+    /// @param buffer The output buffer, at least serialized_size bytes.
+    void serialize(unsigned char* buffer) const;
+    /// @brief Restores a scene serialized by the same format version.
+    /// @param buffer The input buffer.
+    /// @param size The size of the input buffer.
+    /// @return True, if the buffer held a valid scene.
+    bool deserialize(const unsigned char* buffer, std::size_t size);
+
+    /// @brief The size of a serialized scene in bytes.
+    static const std::size_t serialized_size = 1 + (max_name_length + 1) + Shutter::Device::ALL + 1 + 4 * Shutter::Device::ALL;
+
+private:
+    /// @brief Compiles the transmit plan from the target positions.
+    void compile();
+    /// @brief Returns the devices sharing a target position.
+    /// @param position The target position.
+    /// @return The device mask.
+    unsigned char maskOf(signed char position) const;
+
+    /// @brief The version of the serialized format.
+    static const unsigned char format_version_ = 1;
+
+    /// @brief The name of the scene.
+    char name_[max_name_length + 1] = {};
+    /// @brief The target position of each shutter.
+    std::array<signed char, Shutter::Device::ALL> positions_;
+    /// @brief The precompiled transmit plan.
+    TransmitPlan plan_;
+};
+
+/// @brief Class storing the scenes in memory, persisted to LittleFS.
+class SceneStore
+{
+public:
+    /// @brief The number of scene slots.
+    static const int capacity = 8;
+
+    /// @brief Loads every persisted scene.
+    void loadAll();
+    /// @brief Loads (or forgets) one persisted scene.
+    /// @param id The scene identifier.
+    void load(int id);
+    /// @brief Returns a scene.
+    /// @param id The scene identifier.
+    /// @return Pointer to the scene, nullptr if there is no valid scene with the identifier.
+    const Scene* get(int id) const;
+
+    /// @brief Persists a scene. Does not touch the in-memory scenes, load() must be called afterwards.
+    /// @param id The scene identifier.
+    /// @param scene The scene to persist.
+    /// @return True, if the scene was written.
+    static bool persist(int id, const Scene& scene);
+
+private:
+    /// @brief The scenes.
+    std::array<Scene, capacity> scenes_;
+};
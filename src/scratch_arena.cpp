@@ -0,0 +1,107 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "scratch_arena.h"
+
+#include <cstring>
+
+namespace
+{
+    std::size_t alignUp(std::size_t size)
+    {
+        const std::size_t alignment = alignof(std::max_align_t);
+        return (size + alignment - 1) & ~(alignment - 1);
+    }
+
+    std::size_t& blockSize(void* ptr)
+    {
+        return *reinterpret_cast<std::size_t*>(static_cast<unsigned char*>(ptr) - sizeof(std::max_align_t));
+    }
+}
+
+ScratchArena::ScratchArena() : stats_("json", capacity_)
+{
+}
+
+void* ScratchArena::allocate(size_t size)
+{
+    const auto block_size = alignUp(size);
+    if (used_ + header_size_ + block_size > capacity_)
+    {
+        stats_.recordFailure();
+        return nullptr;
+    }
+    unsigned char* ptr = buffer_ + used_ + header_size_;
+    used_ += header_size_ + block_size;
+    blockSize(ptr) = block_size;
+    stats_.recordAllocation(header_size_ + block_size);
+    return ptr;
+}
+
+void ScratchArena::deallocate(void* ptr)
+{
+    // Released in reset().
+    (void)ptr;
+}
+
+void* ScratchArena::reallocate(void* ptr, size_t new_size)
+{
+    if (ptr == nullptr)
+    {
+        return allocate(new_size);
+    }
+
+    const auto old_size = blockSize(ptr);
+    const auto block_size = alignUp(new_size);
+    const bool last_block = static_cast<unsigned char*>(ptr) + old_size == buffer_ + used_;
+    if (last_block)
+    {
+        // Grow or shrink in place.
+        if (used_ - old_size + block_size > capacity_)
+        {
+            stats_.recordFailure();
+            return nullptr;
+        }
+        used_ = used_ - old_size + block_size;
+        blockSize(ptr) = block_size;
+        stats_.recordFree(old_size);
+        stats_.recordAllocation(block_size);
+        return ptr;
+    }
+
+    if (block_size <= old_size)
+    {
+        return ptr;
+    }
+    void* new_ptr = allocate(new_size);
+    if (new_ptr != nullptr)
+    {
+        std::memcpy(new_ptr, ptr, old_size);
+    }
+    return new_ptr;
+}
+
+void ScratchArena::reset()
+{
+    if (used_ > 0)
+    {
+        stats_.recordFree(used_);
+    }
+    used_ = 0;
+}
+
+const MemoryStats& ScratchArena::stats() const
+{
+    return stats_;
+}
@@ -0,0 +1,54 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "memory_stats.h"
+
+#include <ArduinoJson.h>
+#include <cstddef>
+
+/// @brief Bump allocator serving the short-lived allocations of a single request (e.g. a JsonDocument).
+/// Individual releases are no-ops, the whole arena is released with reset() once the request is handled.
+class ScratchArena : public ArduinoJson::Allocator
+{
+public:
+    /// @brief Default constructor.
+    ScratchArena();
+
+    void* allocate(size_t size) override;
+    void deallocate(void* ptr) override;
+    void* reallocate(void* ptr, size_t new_size) override;
+
+    /// @brief Releases every allocation at once. The users of the arena must be destroyed at this point.
+    void reset();
+
+    /// @brief Returns the allocation statistics of the arena.
+    /// @return The allocation statistics.
+    const MemoryStats& stats() const;
+
+private:
+    /// @brief The size of the arena in bytes. The first allocation of a JsonDocument is a whole variant pool
+    /// (ARDUINOJSON_POOL_CAPACITY slots, ~1 KiB on a 32 bit target), the rest holds the pool list and the strings.
+    static const std::size_t capacity_ = 2048;
+    /// @brief The size of the bookkeeping header stored in front of each block.
+    static const std::size_t header_size_ = sizeof(std::max_align_t);
+
+    /// @brief The arena storage.
+    alignas(std::max_align_t) unsigned char buffer_[capacity_];
+    /// @brief The offset of the first free byte.
+    std::size_t used_ = 0;
+    /// @brief The allocation statistics.
+    MemoryStats stats_;
+};
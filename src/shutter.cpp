@@ -14,17 +14,18 @@
 
 #include <Arduino.h>
 
+#include "event_trace.h"
 #include "shutter.h"
 #include "shutter_params.h"
 
 Shutter::Shutter() : 
-    device_id_(ShutterParams::none_device_id), position_(0), calibrated_(false), time_up_(0), time_down_(0)
+    device_id_(ShutterParams::none_device_id), position_(0), calibrated_(false)
 {
 
 }
 
-Shutter::Shutter(std::shared_ptr<Transmitter> transmitter, unsigned char id, double time_up, double time_down): 
-    device_id_(id), position_(0), time_up_(time_up), time_down_(time_down), transmitter_(transmitter)
+Shutter::Shutter(unsigned char id, RFProtocols::Id protocol, const TravelProfile& up_profile, const TravelProfile& down_profile): 
+    device_id_(id), protocol_(protocol), position_(0), up_profile_(up_profile), down_profile_(down_profile)
 {
 }
 
@@ -33,15 +34,173 @@ bool Shutter::calibrated() const
     return calibrated_;
 }
 
-void Shutter::addCommand(std::unique_ptr<Command> command)
+int Shutter::position() const
 {
-    commands_.push_back(std::move(command));
+    return position_;
 }
 
-void Shutter::executeSend(const std::unique_ptr<Command>& command)
+int Shutter::estimatedPosition(unsigned long now_ms) const
+{
+    if (!motion_.active)
+    {
+        return position_;
+    }
+    const int step = ShutterParams::estimate_step;
+    return (estimatePosition(now_ms) + step / 2) / step * step;
+}
+
+bool Shutter::busy() const
+{
+    return !commands_.empty();
+}
+
+unsigned char Shutter::deviceId() const
+{
+    return device_id_;
+}
+
+RFProtocols::Id Shutter::protocol() const
+{
+    return protocol_;
+}
+
+std::size_t Shutter::queued() const
+{
+    return commands_.size();
+}
+
+bool Shutter::addCommand(std::unique_ptr<Command> command)
+{
+    if (!command || commands_.size() + 1 >= CommandQueue::capacity)
+    {
+        return false;
+    }
+    const int command_id = command->getId();
+    if (!commands_.push_back(std::move(command)))
+    {
+        return false;
+    }
+    EventTrace::record(EventTrace::Type::COMMAND_ENQUEUED, device_id_, command_id);
+    return true;
+}
+
+void Shutter::retarget(std::unique_ptr<Command> command)
+{
+    if (!command)
+    {
+        return;
+    }
+    const int command_id = command->getId();
+    const int target_position = command->getTargetPosition();
+    const bool absolute = command->getType() == Command::Type::ABSOLUTE;
+
+    if (motion_.active && calibrated_)
+    {
+        const int current_position = estimatePosition(millis());
+        Instruction direction = Instruction::STOP;
+        if (target_position > current_position)
+        {
+            direction = Instruction::DOWN;
+        }
+        else if (target_position < current_position)
+        {
+            direction = Instruction::UP;
+        }
+        clearQueue();
+
+        if (direction == motion_.direction)
+        {
+            // Already moving towards the target, only the end time changes: no frame is needed.
+            command->setInstruction(direction);
+            command->setStatus(Command::Status::EXECUTING);
+            command->setEndTime(motion_.start_ms + travelTime(direction, motion_.start_position, target_position));
+            addCommand(std::move(command));
+            if (absolute)
+            {
+                addCommand(std::make_unique<RelativeCommand>(command_id, Instruction::STOP));
+            }
+            return;
+        }
+
+        // Reverse or stop. The motor runs on until the frame is sent, the position is estimated then (see onSent()).
+        if (direction == Instruction::STOP)
+        {
+            addCommand(std::make_unique<RelativeCommand>(command_id, Instruction::STOP));
+            return;
+        }
+        addCommand(std::move(command));
+        return;
+    }
+
+    // Not tracked: a pending STOP (e.g. the one ending an absolute command) is always kept, a running calibration
+    // (or relative motion) is kept for an absolute command, the other commands which were not sent yet are replaced.
+    const bool stopping = !commands_.empty() && commands_.front()->getType() == Command::Type::RELATIVE &&
+        commands_.front()->getInstruction() == Instruction::STOP;
+    const bool running = !commands_.empty() && commands_.front()->getStatus() == Command::Status::EXECUTING;
+    const bool keep_front = stopping || (absolute && running);
+    commands_.truncate(keep_front ? 1 : 0);
+    if (!absolute)
+    {
+        addCommand(std::move(command));
+        return;
+    }
+
+    const bool calibrating = !commands_.empty() && commands_.front()->getType() == Command::Type::CALIBRATE;
+    if (!calibrated_ && !calibrating)
+    {
+        addCommand(std::make_unique<CalibrationCommand>(command_id));
+    }
+    if (calibrated_ && commands_.empty() && target_position == position_)
+    {
+        // Already there.
+        return;
+    }
+    addCommand(std::move(command));
+}
+
+void Shutter::startCommand(std::unique_ptr<Command> command, bool sent, unsigned long sent_at_ms)
+{
+    clearQueue();
+    if (!addCommand(std::move(command)))
+    {
+        return;
+    }
+    onSent(commands_.front(), sent, sent_at_ms);
+}
+
+bool Shutter::prepareSend(Transmitter::Frame& frame)
+{
+    if (commands_.empty())
+    {
+        return false;
+    }
+    auto& command = commands_.front();
+    if (command->getStatus() != Command::Status::TO_BE_SENT)
+    {
+        return false;
+    }
+    if (command->getType() == Command::Type::ABSOLUTE && command->getInstruction() == Instruction::UNKNOWN)
+    {
+        // The direction depends on the position reached by the previous commands, or by the running motion.
+        command->setInstruction(command->getTargetPosition() > estimatePosition(millis()) ? Instruction::DOWN : Instruction::UP);
+    }
+    frame.protocol = protocol_;
+    frame.device_id = device_id_;
+    frame.instruction = command->getInstruction();
+    return true;
+}
+
+void Shutter::completeSend(bool sent, unsigned long sent_at_ms)
+{
+    if (commands_.empty())
+    {
+        return;
+    }
+    onSent(commands_.front(), sent, sent_at_ms);
+}
+
+void Shutter::onSent(const std::unique_ptr<Command>& command, bool sent, unsigned long sent_at_ms)
 {
-    const auto sent = transmitter_->sendCommand(device_id_, command->getInstruction());
-    const auto maybe_sent_at = millis();
     switch (command->getType())
     {
     case Command::Type::RELATIVE:
@@ -53,19 +212,19 @@ void Shutter::executeSend(const std::unique_ptr<Command>& command)
 
         if (command->getInstruction() == Instruction::STOP)
         {
-            command->setEndTime(maybe_sent_at);
+            command->setEndTime(sent_at_ms);
+            endMotion(sent_at_ms);
         }
         else if (command->getInstruction() == Instruction::DOWN)
         {
-            const auto time_down_ms = static_cast<int>(time_down_ * 1000.0);
-            command->setEndTime(maybe_sent_at + time_down_ms);
+            command->setEndTime(sent_at_ms + down_profile_.fullTravelTime());
+            startMotion(Instruction::DOWN, sent_at_ms);
         }
         else // UP and else
         {
-            const auto time_up_ms = static_cast<int>(time_up_ * 1000.0);
-            command->setEndTime(maybe_sent_at + time_up_ms);
+            command->setEndTime(sent_at_ms + up_profile_.fullTravelTime());
+            startMotion(Instruction::UP, sent_at_ms);
         }
-        calibrated_ = false;
         break;
     }
     case Command::Type::CALIBRATE:
@@ -75,35 +234,25 @@ void Shutter::executeSend(const std::unique_ptr<Command>& command)
             break;
         }
 
-        const auto time_up_ms = static_cast<int>(time_up_ * 1000.0);
-        command->setEndTime(maybe_sent_at + time_up_ms);
+        const auto& profile = command->getInstruction() == Instruction::DOWN ? down_profile_ : up_profile_;
+        command->setEndTime(sent_at_ms + profile.fullTravelTime());
+        startMotion(command->getInstruction(), sent_at_ms);
         break;
     }
-        break;
     case Command::Type::ABSOLUTE:
     {
-        int delta_p = command->getTargetPosition() - position_;
-        int dt_ms = 0;
-        // 100 incr ... 25 s
-        if (delta_p > 0)
-        {
-            // Shutter should move down
-            dt_ms = std::round((static_cast<double>(std::abs(delta_p)) / 100.0) * time_down_ * 1000.0);
-        }
-        else //  (delta_p < 0)
-        {
-            // Shutter should move up
-            dt_ms = std::round((static_cast<double>(std::abs(delta_p)) / 100.0) * time_up_ * 1000.0);
-        }
         if (sent)
         {        
-            command->setEndTime(maybe_sent_at + dt_ms);
-            commands_.push_back(std::make_unique<RelativeCommand>(command->getId(), Instruction::STOP));
-        }
-        else // ! sent
-        {
-            Instruction instruction = delta_p > 0 ? Instruction::DOWN : Instruction::UP;
-            command->setInstruction(instruction);
+            endMotion(sent_at_ms);
+            const int dt_ms = travelTime(command->getInstruction(), position_, command->getTargetPosition());
+            command->setEndTime(sent_at_ms + dt_ms);
+            startMotion(command->getInstruction(), sent_at_ms);
+            // The slot is reserved by addCommand(), only an exhausted command pool can prevent stopping.
+            auto stop_command = std::make_unique<RelativeCommand>(command->getId(), Instruction::STOP);
+            if (stop_command)
+            {
+                commands_.push_back(std::move(stop_command));
+            }
         }
         break;
     }
@@ -114,6 +263,7 @@ void Shutter::executeSend(const std::unique_ptr<Command>& command)
     if (sent)
     {
         command->setStatus(Command::Status::EXECUTING);
+        EventTrace::record(EventTrace::Type::COMMAND_EXECUTING, device_id_, command->getId());
     }
 }
 
@@ -122,21 +272,76 @@ void Shutter::executeDone(const std::unique_ptr<Command>& command)
     switch (command->getType())
     {
     case Command::Type::RELATIVE:
+        if (command->getInstruction() == Instruction::STOP)
+        {
+            break;
+        }
+        // A full travel reaches the end position, just like a calibration.
+        calibrated_ = true;
+        position_ = command->getTargetPosition();
+        motion_.active = false;
         break;
     case Command::Type::ABSOLUTE:
     {
+        // The STOP queued behind the command stops the motor.
         position_ = command->getTargetPosition();
+        motion_.active = false;
         break;
     }
     case Command::Type::CALIBRATE:
         calibrated_ = true;
-        position_ = 0;
+        position_ = command->getTargetPosition();
+        motion_.active = false;
         break;
     default:
         break;
     }
 }
 
+void Shutter::startMotion(Instruction direction, unsigned long sent_at_ms)
+{
+    endMotion(sent_at_ms);
+    motion_.active = true;
+    motion_.direction = direction;
+    motion_.start_position = position_;
+    motion_.start_ms = sent_at_ms;
+}
+
+void Shutter::endMotion(unsigned long sent_at_ms)
+{
+    if (motion_.active)
+    {
+        // Stopped or reversed mid-motion, the position is only known if it was known at the start.
+        position_ = estimatePosition(sent_at_ms);
+        motion_.active = false;
+    }
+}
+
+int Shutter::estimatePosition(unsigned long now_ms) const
+{
+    if (!motion_.active)
+    {
+        return position_;
+    }
+    const int elapsed_ms = static_cast<int>(now_ms - motion_.start_ms);
+    if (motion_.direction == Instruction::DOWN)
+    {
+        return down_profile_.progressAfter(motion_.start_position, elapsed_ms);
+    }
+    return 100 - up_profile_.progressAfter(100 - motion_.start_position, elapsed_ms);
+}
+
+int Shutter::travelTime(Instruction direction, int from_position, int to_position) const
+{
+    if (direction == Instruction::DOWN)
+    {
+        // The progress equals the position.
+        return down_profile_.travelTime(from_position, to_position);
+    }
+    // The progress is measured from the bottom.
+    return up_profile_.travelTime(100 - from_position, 100 - to_position);
+}
+
 void Shutter::execute()
 {
     if (commands_.empty())
@@ -150,11 +355,12 @@ void Shutter::execute()
     switch (command->getStatus())
     {
     case Command::Status::TO_BE_SENT:
-        executeSend(command);
+        // Sent by the controller, see prepareSend().
         break;
     case Command::Status::EXECUTING:
         break;
     case Command::Status::DONE:
+        EventTrace::record(EventTrace::Type::COMMAND_DONE, device_id_, command->getId());
         executeDone(command);
         commands_.pop_front();
         break;
@@ -14,9 +14,10 @@
 
 #pragma once
 #include "command.h"
+#include "command_queue.h"
 #include "transmitter.h"
+#include "travel_profile.h"
 #include <memory>
-#include <deque>
 
 /// @brief Class encapsulating a shutter instance.
 class Shutter
@@ -37,39 +38,119 @@ public:
     Shutter();
 
     /// @brief  Constructor.
-    /// @param time_up Time required to move up.
-    /// @param time_down Time required to move down.
-    Shutter(std::shared_ptr<Transmitter> transmitter, unsigned char id, double time_up, double time_down);
+    /// @param id The device id.
+    /// @param protocol The RF protocol of the device.
+    /// @param up_profile The travel model when moving up.
+    /// @param down_profile The travel model when moving down.
+    Shutter(unsigned char id, RFProtocols::Id protocol, const TravelProfile& up_profile, const TravelProfile& down_profile);
     
     /// @brief Returns if the shutter is calibrated.
     /// @return True, if the shutter is calibrated.
     bool calibrated() const;
-    /// @brief Adds a command to the command queue.
+    /// @brief Returns the last known position (0: up, 100: down). During a motion, the position it started from.
+    /// @return The position.
+    int position() const;
+    /// @brief Returns the position to publish: the estimate of the current motion rounded to
+    /// ShutterParams::estimate_step, the last known position if the shutter is not moving.
+    /// @param now_ms The current time in ms.
+    /// @return The estimated position.
+    int estimatedPosition(unsigned long now_ms) const;
+    /// @brief Returns if the shutter has commands to execute.
+    /// @return True, if the command queue is not empty.
+    bool busy() const;
+    /// @brief Returns the device id of the shutter.
+    /// @return The device id used in the frames.
+    unsigned char deviceId() const;
+    /// @brief Returns the RF protocol of the shutter.
+    /// @return The protocol used in the frames.
+    RFProtocols::Id protocol() const;
+
+    /// @brief Returns the number of queued commands (including the executing one).
+    /// @return The number of queued commands.
+    std::size_t queued() const;
+    /// @brief Adds a command to the command queue. One slot is always kept free for the STOP of an absolute command.
+    /// @param command Pointer to the command instance, may be nullptr if the command pool is exhausted.
+    /// @return True, if the command was queued.
+    bool addCommand(std::unique_ptr<Command> command);
+    /// @brief Adds a motion command (absolute, or relative UP/DOWN) with a latest-wins policy.
+    /// If the shutter is moving from a known position, the running motion is preempted: the current position
+    /// is estimated from the elapsed time, and only the direction change or STOP needed to reach the new target
+    /// is sent (nothing at all, if the shutter already moves towards the target). Otherwise the queued commands
+    /// which were not sent yet are replaced.
+    /// @param command Pointer to the command instance.
+    void retarget(std::unique_ptr<Command> command);
+    /// @brief Replaces the command queue with a command whose instruction was already transmitted
+    /// (e.g. as part of a broadcast frame).
     /// @param command Pointer to the command instance.
-    void addCommand(std::unique_ptr<Command> command);
-    /// @brief The main execution cycle.
+    /// @param sent True, if the instruction was transmitted.
+    /// @param sent_at_ms The time of the transmission in ms.
+    void startCommand(std::unique_ptr<Command> command, bool sent, unsigned long sent_at_ms);
+    /// @brief The main execution cycle. Finishes the commands whose time is up; transmission is left to the controller.
     void execute();
+    /// @brief Returns the frame the current command is waiting to send.
+    /// @param frame The output frame.
+    /// @return True, if the current command has to be sent.
+    bool prepareSend(Transmitter::Frame& frame);
+    /// @brief Updates the current command after the frame returned by prepareSend() was transmitted (or not).
+    /// @param sent True, if the frame was transmitted.
+    /// @param sent_at_ms The time of the transmission in ms.
+    void completeSend(bool sent, unsigned long sent_at_ms);
     /// @brief Clears the command queue.
     void clearQueue();
 
 private:
-    /// @brief Executes the command's "send" operation.
-    void executeSend(const std::unique_ptr<Command>& command);
+    /// @brief Updates the command after its instruction was (or failed to be) transmitted.
+    /// @param command The command.
+    /// @param sent True, if the instruction was transmitted.
+    /// @param sent_at_ms The time of the transmission in ms.
+    void onSent(const std::unique_ptr<Command>& command, bool sent, unsigned long sent_at_ms);
     /// @brief Executes the command's "done" operation.
     void executeDone(const std::unique_ptr<Command>& command);
+    /// @brief Records the start of a motion.
+    /// @param direction The direction of the motion.
+    /// @param sent_at_ms The time of the transmission in ms.
+    void startMotion(Instruction direction, unsigned long sent_at_ms);
+    /// @brief Records the end of the current motion (by a STOP or a reversal), at the estimated position.
+    /// @param sent_at_ms The time of the transmission ending the motion in ms.
+    void endMotion(unsigned long sent_at_ms);
+    /// @brief Estimates the position reached by the current motion.
+    /// @param now_ms The time of the estimation in ms.
+    /// @return The estimated position, the last known position if the shutter is not moving.
+    int estimatePosition(unsigned long now_ms) const;
+    /// @brief Returns the time required to travel between two positions.
+    /// @param direction The direction of the travel.
+    /// @param from_position The starting position.
+    /// @param to_position The target position.
+    /// @return The travel time [ms].
+    int travelTime(Instruction direction, int from_position, int to_position) const;
+
+    /// @brief Struct describing the motion the shutter was last commanded to.
+    struct Motion
+    {
+        /// @brief True, if the shutter is moving.
+        bool active = false;
+        /// @brief The direction of the motion.
+        Instruction direction = Instruction::UNKNOWN;
+        /// @brief The position at the start of the motion.
+        int start_position = 0;
+        /// @brief The time the motion's frame was sent. [ms]
+        unsigned long start_ms = 0;
+    };
 
     /// @brief The device id.
     unsigned char device_id_ = 0b000000111;
-    /// @brief The current position (0: up, 100: down). 
+    /// @brief The RF protocol of the device.
+    RFProtocols::Id protocol_ = RFProtocols::Id::STANDARD;
+    /// @brief The last known position (0: up, 100: down), the start position while moving. 
     int position_ = 0;
     /// @brief Stores if the position is valid (the shutter is calibrated).
     bool calibrated_ = false; 
-    /// @brief Time required to move up [s].
-    double time_up_ = 0.0;
-    /// @brief Time required to move down. [s]
-    double time_down_ = 0.0;
+    /// @brief The travel model when moving up.
+    TravelProfile up_profile_;
+    /// @brief The travel model when moving down.
+    TravelProfile down_profile_;
     /// @brief The command queue for this shutter.
-    std::deque<std::unique_ptr<Command>> commands_;
-    /// @brief Pointer to the transmitter instance.
-    std::shared_ptr<Transmitter> transmitter_;
+    CommandQueue commands_;
+    /// @brief The current motion.
+    Motion motion_;
 };
@@ -13,43 +13,46 @@
 // ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "shutter_controller.h"
+#include "event_trace.h"
 #include "shutter_params.h"
 
-ShutterController::ShutterController(int transmit_pin)
+#include <algorithm>
+
+ShutterController::ShutterController(int transmit_pin):
+    transmitter_(transmit_pin)
 {
-    transmitter_ = std::make_shared<Transmitter>(transmit_pin);
     shutters_[Shutter::Device::LIVING_DOOR] = 
       Shutter(
-        transmitter_,
         ShutterParams::living_door_device_id,
-        ShutterParams::living_room_door_time_up, 
-        ShutterParams::living_room_door_time_down);
+        ShutterParams::living_door_protocol,
+        TravelProfile(ShutterParams::living_room_door_up, ShutterParams::motor_start_delay_ms),
+        TravelProfile(ShutterParams::living_room_door_down, ShutterParams::motor_start_delay_ms));
     shutters_[Shutter::Device::LIVING_WINDOW] = 
       Shutter(
-        transmitter_,
         ShutterParams::living_window_device_id,
-        ShutterParams::living_room_window_time_up, 
-        ShutterParams::living_room_window_time_down);
+        ShutterParams::living_window_protocol,
+        TravelProfile(ShutterParams::living_room_window_up, ShutterParams::motor_start_delay_ms),
+        TravelProfile(ShutterParams::living_room_window_down, ShutterParams::motor_start_delay_ms));
     shutters_[Shutter::Device::BEDROOM_DOOR] = 
       Shutter(
-        transmitter_,
         ShutterParams::bedroom_door_device_id,
-        ShutterParams::bedroom_door_time_up, 
-        ShutterParams::bedroom_door_time_down);
+        ShutterParams::bedroom_door_protocol,
+        TravelProfile(ShutterParams::bedroom_door_up, ShutterParams::motor_start_delay_ms),
+        TravelProfile(ShutterParams::bedroom_door_down, ShutterParams::motor_start_delay_ms));
     shutters_[Shutter::Device::BEDROOM_WINDOW] = 
       Shutter(
-        transmitter_,
         ShutterParams::bedroom_window_device_id,
-        ShutterParams::bedroom_window_time_up, 
-        ShutterParams::bedroom_window_time_down);
+        ShutterParams::bedroom_window_protocol,
+        TravelProfile(ShutterParams::bedroom_window_up, ShutterParams::motor_start_delay_ms),
+        TravelProfile(ShutterParams::bedroom_window_down, ShutterParams::motor_start_delay_ms));
 }
 
-void ShutterController::createRelativeCommand(const String& command)
+bool ShutterController::decodeRelativeCommand(const String& command, uint32_t request_id, Request& request)
 {
     // A command has the following format: "3,up"
     if (command[1] != ',')
     {
-        return;
+        return false;
     }
 
     Shutter::Device device = Shutter::Device::UNKNOWN_DEVICE;
@@ -69,7 +72,7 @@ void ShutterController::createRelativeCommand(const String& command)
             device = Shutter::Device::LIVING_DOOR;
             break;
         default:
-            return;
+            return false;
     }
 
     Instruction instruction = Instruction::UNKNOWN;
@@ -86,50 +89,95 @@ void ShutterController::createRelativeCommand(const String& command)
             instruction = Instruction::DOWN;
             break;
         default:
-            return;
+            return false;
     }
-    if (instruction == Instruction::STOP)
+    request = Request();
+    request.type = Request::Type::RELATIVE;
+    request.device = device;
+    request.instruction = instruction;
+    request.request_id = request_id;
+    return true;
+}
+
+ShutterController::PostResult ShutterController::createRelativeCommand(const Request& request)
+{
+    if (post(request))
     {
-        shutters_[device].clearQueue();
+        return PostResult::POSTED;
     }
-    shutters_[device].addCommand(std::make_unique<RelativeCommand>(++current_cmd_id_, instruction));
+    if (request.instruction == Instruction::STOP)
+    {
+        // A flood must not lock out a STOP: it is applied once the requests posted before it are drained.
+        // A STOP still pending keeps its mark: moving it would apply it after requests posted later than it, and
+        // it stops the shutter for the later one too.
+        const unsigned char bit = 1 << request.device;
+        if (!(overflow_stops_.load(std::memory_order_acquire) & bit))
+        {
+            overflow_marks_[request.device] = posted_;
+        }
+        overflow_stops_.fetch_or(bit, std::memory_order_release);
+        return PostResult::POSTED;
+    }
+    return PostResult::INBOX_FULL;
 }
 
-void ShutterController::createAbsoluteCommand(const String& device_str, const String& position_str)
+Shutter::Device ShutterController::decodeDevice(const String& device_str)
 {
-    Shutter::Device device = Shutter::Device::UNKNOWN_DEVICE;
     if (device_str == "living_room_door")
     {
-        device = Shutter::Device::LIVING_DOOR;
+        return Shutter::Device::LIVING_DOOR;
     }
     else if (device_str == "living_room_window")
     {
-        device = Shutter::Device::LIVING_WINDOW;
+        return Shutter::Device::LIVING_WINDOW;
     }
     else if (device_str == "bedroom_door")
     {
-        device = Shutter::Device::BEDROOM_DOOR;
+        return Shutter::Device::BEDROOM_DOOR;
     }
     else if (device_str == "bedroom_window")
     {
-        device = Shutter::Device::BEDROOM_WINDOW;
+        return Shutter::Device::BEDROOM_WINDOW;
     }
-    else
+    return Shutter::Device::UNKNOWN_DEVICE;
+}
+
+const char* ShutterController::deviceName(Shutter::Device device)
+{
+    switch (device)
     {
-        return;
+    case Shutter::Device::LIVING_DOOR:
+        return "living_room_door";
+    case Shutter::Device::LIVING_WINDOW:
+        return "living_room_window";
+    case Shutter::Device::BEDROOM_DOOR:
+        return "bedroom_door";
+    case Shutter::Device::BEDROOM_WINDOW:
+        return "bedroom_window";
+    default:
+        return nullptr;
     }
+}
 
-    if (!shutters_[device].calibrated())
+ShutterController::PostResult ShutterController::createAbsoluteCommand(const String& device_str,
+    const String& position_str, uint32_t request_id)
+{
+    const Shutter::Device device = decodeDevice(device_str);
+    if (device == Shutter::Device::UNKNOWN_DEVICE)
     {
-        shutters_[device].addCommand(std::make_unique<CalibrationCommand>(++current_cmd_id_));
+        return PostResult::UNKNOWN_TARGET;
     }
 
     const int received_position = position_str.toInt();
-    const int target_position = std::max(0, std::min(received_position, 100));
-    shutters_[device].addCommand(std::make_unique<AbsoluteCommand>(++current_cmd_id_, target_position));
+    Request request;
+    request.type = Request::Type::ABSOLUTE;
+    request.device = device;
+    request.position = std::max(0, std::min(received_position, 100));
+    request.request_id = request_id;
+    return post(request) ? PostResult::POSTED : PostResult::INBOX_FULL;
 }
 
-void ShutterController::createCalibrationCommand(const String& device_str)
+ShutterController::PostResult ShutterController::createCalibrationCommand(const String& device_str)
 {
     Shutter::Device device = Shutter::Device::UNKNOWN_DEVICE;
     if (device_str == "0")
@@ -149,16 +197,335 @@ void ShutterController::createCalibrationCommand(const String& device_str)
         device = Shutter::Device::LIVING_WINDOW;
     }
     else
+    {
+        return PostResult::UNKNOWN_TARGET;
+    }
+    Request request;
+    request.type = Request::Type::CALIBRATE;
+    request.device = device;
+    return post(request) ? PostResult::POSTED : PostResult::INBOX_FULL;
+}
+
+ShutterController::PostResult ShutterController::createSceneCommand(const String& scene_str, uint32_t request_id)
+{
+    if (scene_str.length() == 0 || scene_str[0] < '0' || scene_str[0] > '9')
+    {
+        return PostResult::UNKNOWN_TARGET;
+    }
+    const int scene_id = scene_str.toInt();
+    if (scene_id >= SceneStore::capacity)
+    {
+        return PostResult::UNKNOWN_TARGET;
+    }
+    Request request;
+    request.type = Request::Type::RUN_SCENE;
+    request.scene_id = scene_id;
+    request.request_id = request_id;
+    return post(request) ? PostResult::POSTED : PostResult::INBOX_FULL;
+}
+
+bool ShutterController::saveScene(int scene_id, const char* name, const std::array<signed char, Shutter::Device::ALL>& positions)
+{
+    if (!SceneStore::persist(scene_id, Scene(name, positions)))
+    {
+        return false;
+    }
+    Request request;
+    request.type = Request::Type::LOAD_SCENE;
+    request.scene_id = scene_id;
+    return post(request);
+}
+
+void ShutterController::loadScenes()
+{
+    scenes_.loadAll();
+}
+
+void ShutterController::runScene(int scene_id)
+{
+    const Scene* scene = scenes_.get(scene_id);
+    if (scene == nullptr)
     {
         return;
     }
-    shutters_[device].addCommand(std::make_unique<CalibrationCommand>(++current_cmd_id_));
+
+    const int command_id = ++current_cmd_id_;
+    for (const auto& step : scene->getPlan())
+    {
+        if (step.kind == TransmitStep::Kind::BROADCAST && broadcastable())
+        {
+            // A single frame starts every shutter, which only have to track the motion.
+            const auto sent_at_ms = millis();
+            const auto sent = transmitter_.sendCommand(shutters_[0].protocol(), ShutterParams::all_device_id, step.instruction);
+            ++metrics_.broadcasts;
+            for (int device = 0; device < Shutter::Device::ALL; ++device)
+            {
+                shutters_[device].startCommand(std::make_unique<CalibrationCommand>(command_id, step.instruction), sent, sent_at_ms);
+            }
+            continue;
+        }
+
+        for (int device = 0; device < Shutter::Device::ALL; ++device)
+        {
+            if (!(step.device_mask & (1 << device)))
+            {
+                continue;
+            }
+            // The shutters owned by other controllers get the step as a request.
+            Request request;
+            request.type = step.kind == TransmitStep::Kind::ABSOLUTE ? Request::Type::ABSOLUTE : Request::Type::RELATIVE;
+            request.device = static_cast<Shutter::Device>(device);
+            request.instruction = step.instruction;
+            request.position = step.position;
+            if (forward(request))
+            {
+                continue;
+            }
+            auto& shutter = shutters_[device];
+            if (step.kind == TransmitStep::Kind::ABSOLUTE)
+            {
+                shutter.retarget(std::make_unique<AbsoluteCommand>(command_id, step.position));
+            }
+            else // FRAME, or a BROADCAST to shutters of different protocols
+            {
+                shutter.retarget(std::make_unique<RelativeCommand>(command_id, step.instruction));
+            }
+        }
+    }
+}
+
+bool ShutterController::forward(const Request& request)
+{
+    if (request.forwarded || forwarder_ == nullptr || (local_mask_ & (1 << request.device)))
+    {
+        return false;
+    }
+    return forwarder_(forwarder_context_, request);
+}
+
+void ShutterController::setForwarder(Forwarder forwarder, void* context)
+{
+    forwarder_ = forwarder;
+    forwarder_context_ = context;
+}
+
+void ShutterController::setLocalDevices(unsigned char mask)
+{
+    local_mask_ = mask;
+}
+
+void ShutterController::mirrorState(Shutter::Device device, const StateSnapshot::ShutterState& state)
+{
+    mirrored_states_[device] = state;
+}
+
+void ShutterController::applyRequest(const Request& request)
+{
+    if (duplicates_.duplicate(request, millis()))
+    {
+        ++metrics_.suppressed_duplicates;
+        return;
+    }
+    if (request.type != Request::Type::RUN_SCENE && request.type != Request::Type::LOAD_SCENE && forward(request))
+    {
+        return;
+    }
+    if (request.type == Request::Type::RUN_SCENE)
+    {
+        runScene(request.scene_id);
+        return;
+    }
+    if (request.type == Request::Type::LOAD_SCENE)
+    {
+        scenes_.load(request.scene_id);
+        return;
+    }
+
+    auto& shutter = shutters_[request.device];
+    switch (request.type)
+    {
+    case Request::Type::RELATIVE:
+        if (request.instruction == Instruction::STOP)
+        {
+            shutter.clearQueue();
+            shutter.addCommand(std::make_unique<RelativeCommand>(++current_cmd_id_, request.instruction));
+            break;
+        }
+        shutter.retarget(std::make_unique<RelativeCommand>(++current_cmd_id_, request.instruction));
+        break;
+    case Request::Type::ABSOLUTE:
+        shutter.retarget(std::make_unique<AbsoluteCommand>(++current_cmd_id_, request.position));
+        break;
+    case Request::Type::CALIBRATE:
+        shutter.addCommand(std::make_unique<CalibrationCommand>(++current_cmd_id_));
+        break;
+    default:
+        break;
+    }
+}
+
+bool ShutterController::broadcastable() const
+{
+    return local_mask_ == (1 << Shutter::Device::ALL) - 1 && std::all_of(shutters_.begin(), shutters_.end(),
+        [this](const Shutter& shutter) { return shutter.protocol() == shutters_[0].protocol(); });
+}
+
+void ShutterController::transmitPending()
+{
+    std::array<Transmitter::Frame, Shutter::Device::ALL> frames;
+    std::array<Shutter*, Shutter::Device::ALL> senders;
+    std::size_t count = 0;
+    for (auto& shutter: shutters_)
+    {
+        if (shutter.prepareSend(frames[count]))
+        {
+            senders[count++] = &shutter;
+        }
+    }
+    if (count == 0)
+    {
+        return;
+    }
+
+    const bool same_instruction = std::all_of(frames.begin(), frames.begin() + count,
+        [&frames](const Transmitter::Frame& frame) { return frame.instruction == frames[0].instruction; });
+    if (count == shutters_.size() && same_instruction && broadcastable())
+    {
+        // Every shutter waits for the same instruction, a single broadcast frame starts them at once.
+        const auto sent_at_ms = millis();
+        const auto sent = transmitter_.sendCommand(frames[0].protocol, ShutterParams::all_device_id, frames[0].instruction);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            senders[i]->completeSend(sent, sent_at_ms);
+        }
+        ++metrics_.broadcasts;
+        return;
+    }
+
+    // Each shutter's end time is measured from the first repetition of its own frame, the one its receiver acts on.
+    const auto skew_us = transmitter_.sendCommands(frames.data(), count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        senders[i]->completeSend(frames[i].sent, frames[i].sent_at_ms);
+    }
+    if (count > 1)
+    {
+        metrics_.recordGroupTransmission(skew_us);
+    }
+}
+
+bool ShutterController::post(const Request& request)
+{
+    recordRequest(request);
+    if (!inbox_.push(request))
+    {
+        return false;
+    }
+    ++posted_;
+    return true;
+}
+
+void ShutterController::recordRequest(const Request& request) const
+{
+    const bool has_device = request.device >= 0 && request.device < Shutter::Device::ALL &&
+        request.type != Request::Type::RUN_SCENE && request.type != Request::Type::LOAD_SCENE;
+    EventTrace::record(EventTrace::Type::REQUEST_RECEIVED,
+        has_device ? shutters_[request.device].deviceId() : EventTrace::no_device, request.type);
+}
+
+bool ShutterController::submit(const Request& request)
+{
+    if (request.type == Request::Type::UNKNOWN)
+    {
+        return false;
+    }
+    if (request.type != Request::Type::RUN_SCENE && request.type != Request::Type::LOAD_SCENE &&
+        (request.device < 0 || request.device >= Shutter::Device::ALL))
+    {
+        return false;
+    }
+    recordRequest(request);
+    applyRequest(request);
+    return true;
+}
+
+const Shutter& ShutterController::getShutter(Shutter::Device device) const
+{
+    return shutters_[device];
+}
+
+void ShutterController::updateSnapshot()
+{
+    const auto now_ms = millis();
+    std::array<StateSnapshot::ShutterState, StateSnapshot::shutter_count> states;
+    for (std::size_t device = 0; device < states.size(); ++device)
+    {
+        if (local_mask_ & (1 << device))
+        {
+            const auto& shutter = shutters_[device];
+            states[device].position = shutter.estimatedPosition(now_ms);
+            states[device].calibrated = shutter.calibrated();
+            states[device].queued = shutter.queued();
+        }
+        else
+        {
+            // Owned by another controller, as last announced.
+            states[device] = mirrored_states_[device];
+        }
+        states[device].name = deviceName(static_cast<Shutter::Device>(device));
+    }
+    state_snapshot_.update(states);
+}
+
+const StateSnapshot& ShutterController::stateSnapshot() const
+{
+    return state_snapshot_;
+}
+
+const Metrics& ShutterController::metrics() const
+{
+    return metrics_;
+}
+
+void ShutterController::applyOverflowStops()
+{
+    const unsigned char overflow_stops = overflow_stops_.load(std::memory_order_acquire);
+    for (int device = 0; device < Shutter::Device::ALL; ++device)
+    {
+        if (!(overflow_stops & (1 << device)) || static_cast<int32_t>(drained_ - overflow_marks_[device]) < 0)
+        {
+            continue;
+        }
+        overflow_stops_.fetch_and(~(1 << device), std::memory_order_relaxed);
+        // A bare STOP, never taken for a duplicate of the last drained request.
+        Request stop;
+        stop.type = Request::Type::RELATIVE;
+        stop.device = static_cast<Shutter::Device>(device);
+        stop.instruction = Instruction::STOP;
+        applyRequest(stop);
+    }
 }
 
 void ShutterController::execute()
 {
+    // The overflow STOPs are applied in their place among the drained requests: after the requests posted before
+    // them, before the ones posted later.
+    while (true)
+    {
+        applyOverflowStops();
+        Request request;
+        if (!inbox_.pop(request))
+        {
+            break;
+        }
+        ++drained_;
+        applyRequest(request);
+    }
+
     for (auto& shutter: shutters_)
     {
         shutter.execute();
     }
+    transmitPending();
+    updateSnapshot();
 }
@@ -13,43 +13,201 @@
 // ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
+#include "duplicate_filter.h"
+#include "metrics.h"
+#include "request.h"
+#include "scene.h"
 #include "shutter.h"
+#include "spsc_queue.h"
+#include "state_snapshot.h"
 #include "transmitter.h"
 
 #include "Arduino.h"
 #include <array>
+#include <atomic>
 
 /// @brief Class encapsulating the shutter controller logic.
 class ShutterController
 {
 public:
+    /// @brief Enum for the result of posting a request to the control loop.
+    enum PostResult
+    {
+        /// @brief The request was posted.
+        POSTED,
+        /// @brief The request named an unknown device or scene, nothing was posted.
+        UNKNOWN_TARGET,
+        /// @brief The inbox is full: the control loop is behind.
+        INBOX_FULL
+    };
+
     /// @brief  Constructor.
     /// @param transmit_pin The transmit pin on the board.
     ShutterController(int transmit_pin);
 
-    /// @brief Executes the main control loop.
+    /// @brief Executes the main control loop. Applies the pending requests first.
     void execute();
 
-    /// @brief Decodoes a command from the input string.
+    /// @brief Decodes a relative command from the input string (e.g. "3,up").
     /// @param command The command to decode.
-    /// @return A shutter command representation of the input command.
-    void createRelativeCommand(const String& command);
+    /// @param request_id The client supplied id of the request, 0 if none.
+    /// @param request The decoded request.
+    /// @return True, if the command is valid.
+    static bool decodeRelativeCommand(const String& command, uint32_t request_id, Request& request);
+
+    /// @brief Posts a decoded relative command to the control loop.
+    /// May be called from the async web server context. A STOP is accepted even if the inbox is full.
+    /// @param request The request returned by decodeRelativeCommand().
+    /// @return POSTED or INBOX_FULL.
+    PostResult createRelativeCommand(const Request& request);
 
-    /// @brief Decodes an absolute command based on the inputs.
+    /// @brief Decodes an absolute command based on the inputs, and posts it to the control loop.
+    /// May be called from the async web server context.
     /// @param device_str The string representation of the commanded device.
     /// @param position_str The string representation of the absolute target position.
-    /// @return A shutter command representation of the input command.
-    void createAbsoluteCommand(const String& device_str, const String& position_str);
+    /// @param request_id The client supplied id of the request, 0 if none.
+    /// @return POSTED, UNKNOWN_TARGET or INBOX_FULL.
+    PostResult createAbsoluteCommand(const String& device_str, const String& position_str, uint32_t request_id = 0);
 
-    /// @brief Decodes a calibration command.
+    /// @brief Decodes a calibration command, and posts it to the control loop.
+    /// May be called from the async web server context.
     /// @param device_str The string representation of the commanded device.
-    /// @return A shutter command representation of the input command.
-    void createCalibrationCommand(const String& device_str);
+    /// @return POSTED, UNKNOWN_TARGET or INBOX_FULL.
+    PostResult createCalibrationCommand(const String& device_str);
+
+    /// @brief Decodes a scene command, and posts it to the control loop.
+    /// May be called from the async web server context.
+    /// @param scene_str The string representation of the scene identifier.
+    /// @param request_id The client supplied id of the request, 0 if none.
+    /// @return POSTED, UNKNOWN_TARGET or INBOX_FULL.
+    PostResult createSceneCommand(const String& scene_str, uint32_t request_id = 0);
+
+    /// @brief Compiles and persists a scene, then posts its reload to the control loop.
+    /// May be called from the async web server context.
+    /// @param scene_id The scene identifier.
+    /// @param name The name of the scene.
+    /// @param positions The target position of each shutter, or Scene::untouched. A scene without targets is deleted.
+    /// @return True, if the scene was persisted.
+    bool saveScene(int scene_id, const char* name, const std::array<signed char, Shutter::Device::ALL>& positions);
+
+    /// @brief Loads the persisted scenes. Must be called before the control loop starts.
+    void loadScenes();
+
+    /// @brief Decodes a device from its name (e.g. "living_room_door").
+    /// @param device_str The name of the device.
+    /// @return The device, UNKNOWN_DEVICE if the name is not known.
+    static Shutter::Device decodeDevice(const String& device_str);
+
+    /// @brief Returns the name of a device, the inverse of decodeDevice().
+    /// @param device The device.
+    /// @return The name of the device, nullptr for an unknown device.
+    static const char* deviceName(Shutter::Device device);
+
+    /// @brief Applies a request right away. Only called from the control loop context (e.g. the UDP server).
+    /// @param request The decoded request.
+    /// @return True, if the request was valid.
+    bool submit(const Request& request);
+
+    /// @brief Returns a shutter, for reading its state.
+    /// @param device The shutter device.
+    /// @return The shutter.
+    const Shutter& getShutter(Shutter::Device device) const;
+
+    /// @brief Returns the pre-serialized state of every shutter. May be read from the async web server context.
+    /// @return The state snapshot.
+    const StateSnapshot& stateSnapshot() const;
+
+    /// @brief Returns the runtime metrics.
+    /// @return The runtime metrics.
+    const Metrics& metrics() const;
+
+    /// @brief Forwards a request of a shutter owned by another controller.
+    /// @return True, if the owner acknowledged the request, false to apply it locally.
+    using Forwarder = bool (*)(void* context, const Request& request);
+
+    /// @brief Sets the forwarder of the requests of the shutters owned by other controllers. Only called from the
+    /// control loop.
+    /// @param forwarder The forwarder, nullptr to apply every request locally.
+    /// @param context The context passed to the forwarder.
+    void setForwarder(Forwarder forwarder, void* context);
+
+    /// @brief Sets the shutters owned by this controller, the requests of the others are forwarded.
+    /// Only called from the control loop.
+    /// @param mask The owned shutters (bit n = Shutter::Device n).
+    void setLocalDevices(unsigned char mask);
+
+    /// @brief Sets the state of a shutter owned by another controller, shown in the state snapshot.
+    /// Only called from the control loop.
+    /// @param device The shutter device.
+    /// @param state The state reported by the owner.
+    void mirrorState(Shutter::Device device, const StateSnapshot::ShutterState& state);
 
 private:
+    /// @brief Posts a request from the async web server context to the control loop.
+    /// @param request The decoded request.
+    /// @return True, if the request was accepted, false if the inbox is full.
+    bool post(const Request& request);
+
+    /// @brief Applies the overflow STOPs whose preceding requests were all drained from the inbox.
+    void applyOverflowStops();
+
+    /// @brief Records the reception of a request in the event trace.
+    /// @param request The decoded request.
+    void recordRequest(const Request& request) const;
+
+    /// @brief Rebuilds the state snapshot if a shutter's state changed.
+    void updateSnapshot();
+
+    /// @brief Returns if a broadcast frame reaches every shutter.
+    /// @return True, if every shutter is owned by this controller and uses the same RF protocol.
+    bool broadcastable() const;
+
+    /// @brief Forwards a request if its shutter is owned by another controller.
+    /// @param request The request of a shutter.
+    /// @return True, if the request was forwarded and acknowledged by the owner.
+    bool forward(const Request& request);
+
+    /// @brief Transmits the frames of every shutter waiting to send, as one broadcast frame if possible,
+    /// otherwise with interleaved repetitions.
+    void transmitPending();
+
+    /// @brief Replays the precompiled transmit plan of a scene.
+    /// @param scene_id The scene identifier.
+    void runScene(int scene_id);
+
+    /// @brief Creates the shutter commands of a request. Only called from the control loop.
+    /// @param request The decoded request.
+    void applyRequest(const Request& request);
+
+    /// @brief The requests posted by the web server, drained by the control loop on every tick.
+    SpscQueue<Request, 16> inbox_;
+    /// @brief The devices to stop, which did not fit into the inbox (bit mask of Shutter::Device).
+    std::atomic<unsigned char> overflow_stops_ {0};
+    /// @brief The number of requests posted before each overflow STOP, published by overflow_stops_.
+    std::array<uint32_t, Shutter::Device::ALL> overflow_marks_ {};
+    /// @brief The number of requests posted to the inbox, only written by the async web server context.
+    uint32_t posted_ = 0;
+    /// @brief The number of requests drained from the inbox, only accessed by the control loop.
+    uint32_t drained_ = 0;
+    /// @brief The transmitter, shared by every shutter.
+    Transmitter transmitter_;
     /// @brief Container storing the shutters.
     std::array<Shutter, 4> shutters_; //
-    /// @brief The transmitter.
-    std::shared_ptr<Transmitter> transmitter_;
+    /// @brief The scenes, only accessed from the control loop.
+    SceneStore scenes_;
+    /// @brief The runtime metrics.
+    Metrics metrics_;
+    /// @brief The recent requests, to suppress the duplicates.
+    DuplicateFilter duplicates_;
+    /// @brief The pre-serialized state of every shutter.
+    StateSnapshot state_snapshot_;
+    /// @brief The forwarder of the requests of the shutters owned by other controllers.
+    Forwarder forwarder_ = nullptr;
+    /// @brief The context of the forwarder.
+    void* forwarder_context_ = nullptr;
+    /// @brief The shutters owned by this controller (bit n = Shutter::Device n).
+    unsigned char local_mask_ = (1 << Shutter::Device::ALL) - 1;
+    /// @brief The states of the shutters owned by other controllers.
+    std::array<StateSnapshot::ShutterState, Shutter::Device::ALL> mirrored_states_;
     int current_cmd_id_ = -1;
 };
@@ -14,23 +14,42 @@
 
 #pragma once
 
+#include "rf_protocol.h"
+#include "travel_profile.h"
+
+/// @brief Struct containing the parameters of the shutters.
+/// The travel tables hold the time required to reach every 10 % of a full travel, in the direction of travel.
+/// They default to a constant speed over the measured full travel time; measured points can replace them
+/// to model the non-linear travel (slats stacking near the top, motor spin-up).
+/// Every shutter is bound to the RF protocol of its brand, see RFProtocols.
 struct ShutterParams
 {
     static const unsigned char bedroom_window_device_id = 0b000000001;
-    static constexpr double bedroom_window_time_up = 26.695;
-    static constexpr double bedroom_window_time_down = 26.1;
+    static const RFProtocols::Id bedroom_window_protocol = RFProtocols::Id::STANDARD;
+    static constexpr TravelProfile::Table bedroom_window_up = TravelProfile::linear(26695);
+    static constexpr TravelProfile::Table bedroom_window_down = TravelProfile::linear(26100);
 
     static const unsigned char bedroom_door_device_id = 0b00000010;
-    static constexpr double bedroom_door_time_up = 26.457;
-    static constexpr double bedroom_door_time_down = 25.06;
+    static const RFProtocols::Id bedroom_door_protocol = RFProtocols::Id::STANDARD;
+    static constexpr TravelProfile::Table bedroom_door_up = TravelProfile::linear(26457);
+    static constexpr TravelProfile::Table bedroom_door_down = TravelProfile::linear(25060);
 
     static const unsigned char living_window_device_id = 0b00000011;
-    static constexpr double living_room_window_time_up = 24.5;
-    static constexpr double living_room_window_time_down = 25.06;
+    static const RFProtocols::Id living_window_protocol = RFProtocols::Id::STANDARD;
+    static constexpr TravelProfile::Table living_room_window_up = TravelProfile::linear(24500);
+    static constexpr TravelProfile::Table living_room_window_down = TravelProfile::linear(25060);
 
     static const unsigned char living_door_device_id = 0b00000100;
-    static constexpr double living_room_door_time_up = 26.1;
-    static constexpr double living_room_door_time_down = 24.76;
+    static const RFProtocols::Id living_door_protocol = RFProtocols::Id::STANDARD;
+    static constexpr TravelProfile::Table living_room_door_up = TravelProfile::linear(26100);
+    static constexpr TravelProfile::Table living_room_door_down = TravelProfile::linear(24760);
+
+    /// @brief The delay between the start of a frame's first repetition and the motor starting to move, beyond the
+    /// same delay of the STOP ending the motion [ms]. The travel times are measured from the first repetition.
+    static const unsigned short motor_start_delay_ms = 0;
+    /// @brief The published position of a moving shutter is rounded to this step, so the state changes about once a
+    /// second during a motion instead of on every tick. [%]
+    static const int estimate_step = 5;
 
     static const unsigned char all_device_id = 0b00000000;
     static const unsigned char none_device_id = 0b00000101;
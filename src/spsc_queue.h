@@ -0,0 +1,77 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/// @brief Fixed-size, lock-free queue for exactly one producer and one consumer.
+/// @tparam T The element type.
+/// @tparam Capacity The number of slots, one of which is always kept free. Must be a power of two.
+template <typename T, std::size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two.");
+
+public:
+    /// @brief Appends an element. May only be called from the producer side.
+    /// @param item The element to append.
+    /// @return True, if the element was stored, false if the queue is full.
+    bool push(const T& item)
+    {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        const auto next = (tail + 1) & mask_;
+        if (next == head_.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        items_[tail] = item;
+        tail_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Removes the oldest element. May only be called from the consumer side.
+    /// @param item The output element.
+    /// @return True, if an element was removed, false if the queue is empty.
+    bool pop(T& item)
+    {
+        const auto head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        item = items_[head];
+        head_.store((head + 1) & mask_, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Returns if the queue is empty. Only a snapshot when called from the producer side.
+    /// @return True, if the queue is empty.
+    bool empty() const
+    {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    /// @brief The index mask used for wrapping around.
+    static constexpr std::size_t mask_ = Capacity - 1;
+    /// @brief The element storage.
+    std::array<T, Capacity> items_ {};
+    /// @brief The index of the oldest element, written by the consumer.
+    std::atomic<std::size_t> head_ {0};
+    /// @brief The index of the next free slot, written by the producer.
+    std::atomic<std::size_t> tail_ {0};
+};
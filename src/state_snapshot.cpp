@@ -0,0 +1,87 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "state_snapshot.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    /// @brief The nonce of the ETags, see StateSnapshot::setBootNonce().
+    std::uint32_t boot_nonce = 0;
+}
+
+void StateSnapshot::update(const std::array<ShutterState, shutter_count>& states)
+{
+    if (!empty_ && states == states_)
+    {
+        return;
+    }
+    empty_ = false;
+    states_ = states;
+
+    // Written into the buffer not in use, then published by incrementing the version.
+    // A rebuild is at most every control tick, so a reader always gets through after a retry.
+    const unsigned long next_version = version_.load(std::memory_order_relaxed) + 1;
+    auto& buffer = buffers_[next_version & 1];
+    std::size_t length = snprintf(buffer.data(), buffer.size(), "{\"version\":%lu,\"shutters\":[", next_version);
+    for (std::size_t i = 0; i < shutter_count && length < buffer.size(); ++i)
+    {
+        length += snprintf(buffer.data() + length, buffer.size() - length,
+            "%s{\"name\":\"%s\",\"position\":%d,\"calibrated\":%s,\"queued\":%u}",
+            i == 0 ? "" : ",", states[i].name, states[i].position, states[i].calibrated ? "true" : "false",
+            static_cast<unsigned>(states[i].queued));
+    }
+    if (length < buffer.size())
+    {
+        length += snprintf(buffer.data() + length, buffer.size() - length, "]}");
+    }
+    lengths_[next_version & 1] = length < buffer.size() ? length : buffer.size() - 1;
+    version_.store(next_version, std::memory_order_release);
+}
+
+const StateSnapshot::ShutterState& StateSnapshot::state(std::size_t device) const
+{
+    return states_[device];
+}
+
+unsigned long StateSnapshot::version() const
+{
+    return version_.load(std::memory_order_acquire);
+}
+
+void StateSnapshot::setBootNonce(std::uint32_t nonce)
+{
+    boot_nonce = nonce;
+}
+
+void StateSnapshot::formatEtag(unsigned long version, char* etag)
+{
+    snprintf(etag, etag_size, "\"%08lx-%lu\"", static_cast<unsigned long>(boot_nonce), version);
+}
+
+std::size_t StateSnapshot::copy(char* buffer, unsigned long& version) const
+{
+    std::size_t length = 0;
+    do
+    {
+        version = version_.load(std::memory_order_acquire);
+        length = lengths_[version & 1];
+        memcpy(buffer, buffers_[version & 1].data(), length);
+        buffer[length] = '\0';
+        // Retried if a rebuild started meanwhile, it may have been writing the same buffer.
+    } while (version_.load(std::memory_order_acquire) != version);
+    return length;
+}
@@ -0,0 +1,91 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Class holding the pre-serialized JSON state of every shutter.
+///
+/// Rebuilt by the control loop only when a shutter's state changes; every rebuild increments the version,
+/// which is used in the ETag of /api/state together with a per-boot nonce. Readers in the async web server context get a consistent copy
+/// through a double buffer and a sequence check.
+class StateSnapshot
+{
+public:
+    /// @brief The number of shutters in the snapshot.
+    static const std::size_t shutter_count = 4;
+    /// @brief The size of a serialized snapshot buffer.
+    static const std::size_t buffer_size = 384;
+    /// @brief The size of an ETag buffer.
+    static const std::size_t etag_size = 24;
+
+    /// @brief Struct encapsulating the state of a shutter.
+    struct ShutterState
+    {
+        const char* name = "";
+        int position = 0;
+        bool calibrated = false;
+        std::size_t queued = 0;
+
+        bool operator==(const ShutterState& other) const
+        {
+            return position == other.position && calibrated == other.calibrated && queued == other.queued;
+        }
+    };
+
+    /// @brief Rebuilds the snapshot if any state changed. Only called from the control loop.
+    /// @param states The current states.
+    void update(const std::array<ShutterState, shutter_count>& states);
+
+    /// @brief Returns the last state of a shutter. Only called from the control loop.
+    /// @param device The device index, less than shutter_count.
+    /// @return The state of the last update.
+    const ShutterState& state(std::size_t device) const;
+
+    /// @brief Returns the version of the snapshot.
+    /// @return The version, incremented on every rebuild.
+    unsigned long version() const;
+
+    /// @brief Sets the nonce of the ETags. The version restarts on every boot, so a tag cached before a reboot
+    /// must not match. Called once at startup.
+    /// @param nonce A random number.
+    static void setBootNonce(std::uint32_t nonce);
+
+    /// @brief Formats the ETag of a version.
+    /// @param version The version.
+    /// @param etag The output buffer of etag_size bytes.
+    static void formatEtag(unsigned long version, char* etag);
+
+    /// @brief Copies the current snapshot.
+    /// @param buffer The output buffer of buffer_size bytes.
+    /// @param version The version of the copied snapshot.
+    /// @return The length of the snapshot.
+    std::size_t copy(char* buffer, unsigned long& version) const;
+
+private:
+    /// @brief The last serialized states.
+    std::array<ShutterState, shutter_count> states_;
+    /// @brief The serialized snapshots, written alternately.
+    std::array<std::array<char, buffer_size>, 2> buffers_ {};
+    /// @brief The lengths of the serialized snapshots.
+    std::array<std::size_t, 2> lengths_ {};
+    /// @brief The version of the snapshot, its lowest bit selects the current buffer.
+    std::atomic<unsigned long> version_ {0};
+    /// @brief True, until the first snapshot is built.
+    bool empty_ = true;
+};
@@ -13,6 +13,7 @@
 // ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "transmitter.h"
+#include "event_trace.h"
 #include <Arduino.h>
 
 Transmitter::Transmitter(int transmit_pin): transmit_pin_(transmit_pin)
@@ -23,67 +24,72 @@ Transmitter::Transmitter(int transmit_pin): transmit_pin_(transmit_pin)
     // Initialize the output variables as outputs
     pinMode(transmit_pin_, OUTPUT);
 #endif
-    instructions_[Instruction::UP] = 0b00010001;
-    instructions_[Instruction::DOWN] = 0b00110011;
-    instructions_[Instruction::STOP] = 0b001010101;
 }
 
-void Transmitter::sendWord(unsigned char command) 
+bool Transmitter::transmittable(Instruction instruction)
 {
-    for (unsigned char k = 0; k < 8; k++) 
-    {
-        if ((command >> (7 - k)) & 1 )
-        {
-            // one 
-            digitalWrite(transmit_pin_, HIGH);
-            delayMicroseconds(params_.one_high_send);
-            digitalWrite(transmit_pin_, LOW);    
-            delayMicroseconds(params_.one_low_send);
-        }
-        else
-        {
-            // Zero
-            digitalWrite(transmit_pin_, HIGH);
-            delayMicroseconds(params_.zero_high_send);
-            digitalWrite(transmit_pin_, LOW);    
-            delayMicroseconds(params_.zero_low_send);
-        }
-    }
+    return instruction == Instruction::DOWN || instruction == Instruction::UP || instruction == Instruction::STOP;
 }
 
-void Transmitter::sendSync()
+void Transmitter::sendFrame(const RFProtocols::Entry& protocol, unsigned char device_id, Instruction instruction)
 {
-    digitalWrite(transmit_pin_, HIGH);
-    delayMicroseconds(params_.sync_on);
-    digitalWrite(transmit_pin_, LOW);
-    delayMicroseconds(params_.sync_off);
+    EventTrace::record(EventTrace::Type::FRAME_START, device_id, instruction);
+    protocol.send_frame(transmit_pin_, device_id, instruction);
+    EventTrace::record(EventTrace::Type::FRAME_END, device_id, instruction);
 }
 
-void Transmitter::sendHeader()
-{
-    for (auto header_char : header_)
-    {
-        sendWord(header_char);
-    }
-}
-
-bool Transmitter::sendCommand(unsigned char device_id, Instruction instruction)
+bool Transmitter::sendCommand(RFProtocols::Id protocol, unsigned char device_id, Instruction instruction)
 {
     // It is possible that the instruction is not known at this point.
-    if (instruction != Instruction::DOWN && instruction != Instruction::UP && instruction != Instruction::STOP)
+    if (!transmittable(instruction))
     {
         return false;
     }
 
-    for (int transmission_num = 0; transmission_num < params_.number_of_transmissions; ++transmission_num)
+    const auto& entry = RFProtocols::get(protocol);
+    for (int transmission_num = 0; transmission_num < entry.number_of_transmissions; ++transmission_num)
     {
-        sendSync();
-        sendHeader();
-        sendWord(device_id);
-        sendWord(instructions_[instruction]);
-        delayMicroseconds(params_.delay_between_packets_send);  
+        sendFrame(entry, device_id, instruction);
     }
     return true;
 }
 
+unsigned long Transmitter::sendCommands(Frame* frames, std::size_t count)
+{
+    // The protocols may repeat their frames a different number of times.
+    int number_of_transmissions = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const int transmissions = RFProtocols::get(frames[i].protocol).number_of_transmissions;
+        number_of_transmissions = transmissions > number_of_transmissions ? transmissions : number_of_transmissions;
+    }
 
+    bool first_started = false;
+    unsigned long first_start_us = 0;
+    unsigned long last_start_us = 0;
+    for (int transmission_num = 0; transmission_num < number_of_transmissions; ++transmission_num)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto& frame = frames[i];
+            const auto& protocol = RFProtocols::get(frame.protocol);
+            frame.sent = transmittable(frame.instruction);
+            if (!frame.sent || transmission_num >= protocol.number_of_transmissions)
+            {
+                continue;
+            }
+            if (transmission_num == 0)
+            {
+                last_start_us = micros();
+                frame.sent_at_ms = millis();
+                if (!first_started)
+                {
+                    first_start_us = last_start_us;
+                    first_started = true;
+                }
+            }
+            sendFrame(protocol, frame.device_id, frame.instruction);
+        }
+    }
+    return last_start_us - first_start_us;
+}
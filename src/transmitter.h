@@ -15,8 +15,9 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 
-#include "rf_params.h"
+#include "rf_protocol.h"
 #include "instruction.h"
 
 /// @brief Class acting as a transmitter instance.
@@ -27,25 +28,45 @@ public:
     /// @param transmit_pin The transmit pin.
     Transmitter (int transmit_pin);
 
+    /// @brief Struct encapsulating one frame of a group transmission.
+    struct Frame
+    {
+        /// @brief The protocol of the commanded device.
+        RFProtocols::Id protocol = RFProtocols::Id::STANDARD;
+        /// @brief The commanded device's id.
+        unsigned char device_id = 0;
+        /// @brief The instruction to send.
+        Instruction instruction = Instruction::UNKNOWN;
+        /// @brief Output: true, if the frame was sent.
+        bool sent = false;
+        /// @brief Output: the time the first repetition of the frame was started [ms], the receiver acts on it.
+        unsigned long sent_at_ms = 0;
+    };
+
+    /// @brief Sends every repetition of a frame.
+    /// @param protocol The protocol of the commanded device.
     /// @param device_id The commanded device's id.
     /// @param instruction The command sent.
     /// @return True, if the command was successfully sent.
-    bool sendCommand(unsigned char device_id, Instruction instruction);
+    bool sendCommand(RFProtocols::Id protocol, unsigned char device_id, Instruction instruction);
+
+    /// @brief Sends several frames with their repetitions interleaved round-robin, so that every device
+    /// receives its first repetition within one round instead of after the other devices' full transmissions.
+    /// @param frames The frames to send, the outputs are filled in.
+    /// @param count The number of frames.
+    /// @return The start skew: the time between the first repetition of the first and the last sent frame [us].
+    unsigned long sendCommands(Frame* frames, std::size_t count);
 private:
-    /// @brief Sends a command over the transmit pin.
-    /// @param command The command to send.
-    void sendWord(unsigned char command);
-    /// @brief Sends the synchronization signal before the transmission.
-    void sendSync();
-    /// @brief Sends the message headers.
-    void sendHeader();
+    /// @brief Sends a single repetition of a frame.
+    /// @param protocol The frame generator of the commanded device's protocol.
+    /// @param device_id The commanded device's id.
+    /// @param instruction The command sent.
+    void sendFrame(const RFProtocols::Entry& protocol, unsigned char device_id, Instruction instruction);
+    /// @brief Returns if an instruction can be transmitted.
+    /// @param instruction The instruction.
+    /// @return True, if the instruction has a code.
+    static bool transmittable(Instruction instruction);
 
     /// @brief The transmit pin on the board.
     int transmit_pin_;
-    /// @brief parameter container structure.
-    RFParams params_;
-    /// @brief The static message header, which identifies the shutter's receivers.
-    const std::array<char, 3> header_ {0b11001011, 0b01111010, 0b01010001};
-    /// @brief The array of instructions.
-    std::array<char, 3> instructions_;
 };
@@ -0,0 +1,73 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "travel_profile.h"
+
+#include <algorithm>
+
+TravelProfile::TravelProfile(const Table& table, unsigned short start_delay_ms):
+    table_(table),
+    start_delay_ms_(start_delay_ms)
+{
+}
+
+int TravelProfile::fullTravelTime() const
+{
+    return start_delay_ms_ + table_[point_count - 1];
+}
+
+int TravelProfile::timeAt(int progress) const
+{
+    progress = std::max(0, std::min(progress, 100));
+    const int segment = std::min(progress / point_spacing, point_count - 2);
+    const int t0 = table_[segment];
+    const int t1 = table_[segment + 1];
+    const int offset = progress - segment * point_spacing;
+    // Rounded integer interpolation within the segment.
+    return t0 + ((t1 - t0) * offset + point_spacing / 2) / point_spacing;
+}
+
+int TravelProfile::travelTime(int from_progress, int to_progress) const
+{
+    if (to_progress <= from_progress)
+    {
+        return 0;
+    }
+    return start_delay_ms_ + timeAt(to_progress) - timeAt(from_progress);
+}
+
+int TravelProfile::progressAfter(int from_progress, int elapsed_ms) const
+{
+    const int moving_ms = elapsed_ms - start_delay_ms_;
+    if (moving_ms <= 0)
+    {
+        return from_progress;
+    }
+
+    const int target_ms = timeAt(from_progress) + moving_ms;
+    if (target_ms >= table_[point_count - 1])
+    {
+        return 100;
+    }
+    // The table is short, a linear search is cheaper than a binary one.
+    int segment = 0;
+    while (table_[segment + 1] <= target_ms)
+    {
+        ++segment;
+    }
+    const int t0 = table_[segment];
+    const int t1 = table_[segment + 1];
+    const int progress = segment * point_spacing + ((target_ms - t0) * point_spacing + (t1 - t0) / 2) / (t1 - t0);
+    return std::max(from_progress, progress);
+}
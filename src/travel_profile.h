@@ -0,0 +1,81 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <array>
+
+/// @brief Class modelling the travel of a shutter in one direction with a piecewise-linear table of position vs. time.
+/// Positions are measured along the direction of travel ("progress", 0: starting end position, 100: opposite end position),
+/// times are integer milliseconds, so no floating point math is needed on the target.
+class TravelProfile
+{
+public:
+    /// @brief The number of calibration points.
+    static const int point_count = 11;
+    /// @brief The distance between two calibration points [%].
+    static const int point_spacing = 100 / (point_count - 1);
+
+    /// @brief Table of the time required to reach each calibration point from the starting end position [ms].
+    /// The first value must be 0, the values must be strictly increasing.
+    using Table = std::array<unsigned short, point_count>;
+
+    /// @brief Creates a table for a shutter moving with constant speed.
+    /// @param full_travel_ms The time required for a full travel [ms].
+    /// @return The calibration table.
+    static constexpr Table linear(unsigned short full_travel_ms)
+    {
+        Table table {};
+        for (int i = 0; i < point_count; ++i)
+        {
+            table[i] = static_cast<unsigned short>((static_cast<unsigned long>(full_travel_ms) * i + (point_count - 1) / 2) / (point_count - 1));
+        }
+        return table;
+    }
+
+    /// @brief Default constructor, creates a profile with zero travel time.
+    TravelProfile() = default;
+
+    /// @brief Constructor.
+    /// @param table The calibration table.
+    /// @param start_delay_ms The delay between receiving a frame and the motor starting to move [ms].
+    TravelProfile(const Table& table, unsigned short start_delay_ms = 0);
+
+    /// @brief Returns the time required for a full travel, including the start delay.
+    /// @return The time required for a full travel [ms].
+    int fullTravelTime() const;
+
+    /// @brief Returns the time required to travel between two positions, including the start delay.
+    /// @param from_progress The starting progress [%].
+    /// @param to_progress The target progress [%], not less than from_progress.
+    /// @return The travel time [ms], 0 if there is nothing to travel.
+    int travelTime(int from_progress, int to_progress) const;
+
+    /// @brief Returns the progress reached after moving for a given time, including the start delay.
+    /// @param from_progress The starting progress [%].
+    /// @param elapsed_ms The time elapsed since the frame was sent [ms].
+    /// @return The reached progress [%], at most 100.
+    int progressAfter(int from_progress, int elapsed_ms) const;
+
+private:
+    /// @brief Returns the time needed to reach a progress from the starting end position, without the start delay.
+    /// @param progress The progress [%].
+    /// @return The time [ms].
+    int timeAt(int progress) const;
+
+    /// @brief The calibration table.
+    Table table_ {};
+    /// @brief The delay between receiving a frame and the motor starting to move [ms].
+    unsigned short start_delay_ms_ = 0;
+};
@@ -0,0 +1,54 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "udp_protocol.h"
+
+bool UdpProtocol::decodeCommand(const uint8_t* data, std::size_t size, CommandPacket& packet)
+{
+    if (size != command_size || data[0] != magic || data[1] != version)
+    {
+        return false;
+    }
+    if (data[5] > Opcode::RUN_SCENE)
+    {
+        return false;
+    }
+    packet.sequence = static_cast<uint16_t>(data[2] | (data[3] << 8));
+    packet.device_mask = data[4];
+    packet.opcode = static_cast<Opcode>(data[5]);
+    packet.argument = data[6];
+    return true;
+}
+
+std::size_t UdpProtocol::encodeReply(uint16_t sequence, Status status, const ShutterState* states, std::size_t count,
+    uint8_t* buffer, std::size_t size)
+{
+    const std::size_t reply_size = reply_header_size + 2 * count;
+    if (size < reply_size)
+    {
+        return 0;
+    }
+    buffer[0] = magic;
+    buffer[1] = version;
+    buffer[2] = static_cast<uint8_t>(sequence & 0xFF);
+    buffer[3] = static_cast<uint8_t>(sequence >> 8);
+    buffer[4] = status;
+    buffer[5] = static_cast<uint8_t>(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        buffer[reply_header_size + 2 * i] = states[i].position;
+        buffer[reply_header_size + 2 * i + 1] = (states[i].calibrated ? 0x01 : 0x00) | (states[i].busy ? 0x02 : 0x00);
+    }
+    return reply_size;
+}
@@ -0,0 +1,95 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Struct describing the compact binary UDP control protocol.
+///
+/// Command datagram (8 bytes):
+///   [0] magic ('S')  [1] version  [2..3] sequence number (little endian)
+///   [4] device mask (bit n = Shutter::Device n)  [5] opcode  [6] position / scene id  [7] reserved (0)
+///
+/// Reply datagram (6 + 2 * shutter count bytes):
+///   [0] magic  [1] version  [2..3] echoed sequence number  [4] status  [5] shutter count
+///   then for every shutter: [position] [flags (bit 0: calibrated, bit 1: busy)]
+struct UdpProtocol
+{
+    /// @brief Enum for the command opcodes.
+    enum Opcode : uint8_t
+    {
+        /// @brief Only returns the state snapshot.
+        STATE = 0,
+        UP = 1,
+        DOWN = 2,
+        STOP = 3,
+        /// @brief Absolute move to the position byte.
+        MOVE_TO = 4,
+        CALIBRATE = 5,
+        /// @brief Runs the scene given in the position byte, the device mask is ignored.
+        RUN_SCENE = 6
+    };
+
+    /// @brief Enum for the reply status.
+    enum Status : uint8_t
+    {
+        OK = 0,
+        /// @brief The datagram could not be decoded.
+        BAD_REQUEST = 1,
+        /// @brief (Part of) the command was not accepted.
+        REJECTED = 2
+    };
+
+    /// @brief Struct encapsulating a decoded command datagram.
+    struct CommandPacket
+    {
+        uint16_t sequence = 0;
+        uint8_t device_mask = 0;
+        Opcode opcode = Opcode::STATE;
+        uint8_t argument = 0;
+    };
+
+    /// @brief Struct encapsulating the state of one shutter in a reply.
+    struct ShutterState
+    {
+        uint8_t position = 0;
+        bool calibrated = false;
+        bool busy = false;
+    };
+
+    static const uint8_t magic = 'S';
+    static const uint8_t version = 1;
+    static const std::size_t command_size = 8;
+    static const std::size_t reply_header_size = 6;
+
+    /// @brief Decodes a command datagram.
+    /// @param data The datagram.
+    /// @param size The size of the datagram.
+    /// @param packet The decoded command.
+    /// @return True, if the datagram is a valid command.
+    static bool decodeCommand(const uint8_t* data, std::size_t size, CommandPacket& packet);
+
+    /// @brief Encodes a reply datagram.
+    /// @param sequence The sequence number of the answered command.
+    /// @param status The reply status.
+    /// @param states The state of every shutter.
+    /// @param count The number of shutters.
+    /// @param buffer The output buffer.
+    /// @param size The size of the output buffer.
+    /// @return The size of the reply, 0 if the buffer is too small.
+    static std::size_t encodeReply(uint16_t sequence, Status status, const ShutterState* states, std::size_t count,
+        uint8_t* buffer, std::size_t size);
+};
@@ -0,0 +1,111 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "udp_server.h"
+
+UdpServer::UdpServer(ShutterController& controller, uint16_t port):
+    controller_(controller),
+    port_(port)
+{
+}
+
+void UdpServer::begin()
+{
+    udp_.begin(port_);
+}
+
+bool UdpServer::apply(const UdpProtocol::CommandPacket& packet)
+{
+    Request request;
+    // A retransmitted datagram repeats the sequence number, which makes it the request id.
+    request.request_id = 0x10000u | packet.sequence;
+    switch (packet.opcode)
+    {
+    case UdpProtocol::Opcode::STATE:
+        return true;
+    case UdpProtocol::Opcode::RUN_SCENE:
+        request.type = Request::Type::RUN_SCENE;
+        request.scene_id = packet.argument;
+        return controller_.submit(request);
+    case UdpProtocol::Opcode::UP:
+        request.type = Request::Type::RELATIVE;
+        request.instruction = Instruction::UP;
+        break;
+    case UdpProtocol::Opcode::DOWN:
+        request.type = Request::Type::RELATIVE;
+        request.instruction = Instruction::DOWN;
+        break;
+    case UdpProtocol::Opcode::STOP:
+        request.type = Request::Type::RELATIVE;
+        request.instruction = Instruction::STOP;
+        break;
+    case UdpProtocol::Opcode::MOVE_TO:
+        request.type = Request::Type::ABSOLUTE;
+        request.position = packet.argument > 100 ? 100 : packet.argument;
+        break;
+    case UdpProtocol::Opcode::CALIBRATE:
+        request.type = Request::Type::CALIBRATE;
+        break;
+    default:
+        return false;
+    }
+
+    bool accepted = packet.device_mask != 0;
+    for (int device = 0; device < Shutter::Device::ALL; ++device)
+    {
+        if (packet.device_mask & (1 << device))
+        {
+            request.device = static_cast<Shutter::Device>(device);
+            accepted = controller_.submit(request) && accepted;
+        }
+    }
+    return accepted;
+}
+
+void UdpServer::execute()
+{
+    for (int packet_num = 0; packet_num < max_packets_per_tick; ++packet_num)
+    {
+        const int size = udp_.parsePacket();
+        if (size <= 0)
+        {
+            return;
+        }
+
+        uint8_t buffer[UdpProtocol::reply_header_size + 2 * Shutter::Device::ALL];
+        const auto read = udp_.read(buffer, sizeof(buffer));
+
+        UdpProtocol::CommandPacket packet;
+        UdpProtocol::Status status = UdpProtocol::Status::BAD_REQUEST;
+        if (static_cast<int>(read) == size && UdpProtocol::decodeCommand(buffer, read, packet))
+        {
+            status = apply(packet) ? UdpProtocol::Status::OK : UdpProtocol::Status::REJECTED;
+        }
+
+        // The snapshot includes the shutters owned by the other controllers.
+        std::array<UdpProtocol::ShutterState, Shutter::Device::ALL> states;
+        for (int device = 0; device < Shutter::Device::ALL; ++device)
+        {
+            const auto& state = controller_.stateSnapshot().state(device);
+            states[device].position = static_cast<uint8_t>(state.position);
+            states[device].calibrated = state.calibrated;
+            states[device].busy = state.queued > 0;
+        }
+        const auto reply_size = UdpProtocol::encodeReply(packet.sequence, status, states.data(), states.size(), buffer, sizeof(buffer));
+
+        udp_.beginPacket(udp_.remoteIP(), udp_.remotePort());
+        udp_.write(buffer, reply_size);
+        udp_.endPacket();
+    }
+}
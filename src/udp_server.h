@@ -0,0 +1,53 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "shutter_controller.h"
+#include "udp_protocol.h"
+
+#include <WiFiUdp.h>
+
+/// @brief Class serving the binary UDP control protocol. Polled from the control loop, so the commands
+/// are applied to the controller directly.
+class UdpServer
+{
+public:
+    /// @brief Constructor.
+    /// @param controller The controller to command.
+    /// @param port The UDP port to listen on.
+    UdpServer(ShutterController& controller, uint16_t port);
+
+    /// @brief Starts listening.
+    void begin();
+
+    /// @brief Handles the pending datagrams.
+    void execute();
+
+private:
+    /// @brief Applies a decoded command to the controller.
+    /// @param packet The command.
+    /// @return True, if every part of the command was accepted.
+    bool apply(const UdpProtocol::CommandPacket& packet);
+
+    /// @brief The maximum number of datagrams handled in one tick.
+    static const int max_packets_per_tick = 4;
+
+    /// @brief The controller to command.
+    ShutterController& controller_;
+    /// @brief The UDP port to listen on.
+    uint16_t port_;
+    /// @brief The UDP socket.
+    WiFiUDP udp_;
+};
@@ -0,0 +1,161 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "web_api.h"
+#include "duplicate_filter.h"
+
+namespace
+{
+    const char* command_param = "command";
+    const char* shutter_scale_param = "shutter_scale";
+    const char* scene_param = "scene";
+    const char* id_param = "id";
+    const char* calibrate_param = "calibrate";
+
+    /// @brief Returns the value of the first parameter with the given name.
+    const String* find(const WebApi::Param* params, std::size_t count, const char* name)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (*params[i].name == name)
+            {
+                return params[i].value;
+            }
+        }
+        return nullptr;
+    }
+
+    uint32_t requestId(const WebApi::Param* params, std::size_t count)
+    {
+        const String* id = find(params, count, id_param);
+        return id ? DuplicateFilter::idOf(id->c_str()) : 0;
+    }
+
+    /// @brief Returns the response to the result of posting a request.
+    /// @param posted The response if the request was posted.
+    WebApi::Response responseOf(ShutterController::PostResult result, WebApi::Response posted)
+    {
+        switch (result)
+        {
+        case ShutterController::PostResult::POSTED:
+            return posted;
+        case ShutterController::PostResult::UNKNOWN_TARGET:
+            return WebApi::Response::NOT_FOUND;
+        default:
+            return WebApi::Response::INBOX_FULL;
+        }
+    }
+}
+
+WebApi::WebApi(ShutterController& controller, AdmissionControl& admission):
+    controller_(controller),
+    admission_(admission)
+{
+}
+
+WebApi::Outcome WebApi::handleGet(const Param* params, std::size_t count, std::uint32_t client, unsigned long now_ms)
+{
+    const String* command = find(params, count, command_param);
+    Request relative;
+    const bool decoded = command && ShutterController::decodeRelativeCommand(*command, requestId(params, count), relative);
+    const bool stop = decoded && relative.instruction == Instruction::STOP;
+    if (stop)
+    {
+        controller_.createRelativeCommand(relative);
+    }
+
+    const auto verdict = admission_.admit(client, now_ms);
+    if (verdict != AdmissionControl::Verdict::ADMITTED)
+    {
+        if (stop)
+        {
+            // The STOP was accepted regardless.
+            return {Response::STOPPED, false};
+        }
+        return {verdict == AdmissionControl::Verdict::RATE_LIMITED ? Response::RATE_LIMITED : Response::OVERLOADED, false};
+    }
+    if (stop)
+    {
+        return {Response::PAGE, true};
+    }
+
+    auto result = ShutterController::PostResult::POSTED;
+    const String* scene = find(params, count, scene_param);
+    const String* position_str = find(params, count, shutter_scale_param);
+    if (command)
+    {
+        // Normal motion command
+        if (!decoded)
+        {
+            return {Response::BAD_REQUEST, true};
+        }
+        result = controller_.createRelativeCommand(relative);
+    }
+    else if (scene)
+    {
+        // Scene command
+        result = controller_.createSceneCommand(*scene, requestId(params, count));
+    }
+    else if (position_str)
+    {
+        // Absolute motion command, the other parameters of the form (e.g. scene_id) are not devices.
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (ShutterController::decodeDevice(*params[i].name) == Shutter::Device::UNKNOWN_DEVICE)
+            {
+                continue;
+            }
+            const auto posted = controller_.createAbsoluteCommand(*params[i].name, *position_str, requestId(params, count));
+            if (posted != ShutterController::PostResult::POSTED)
+            {
+                result = posted;
+            }
+        }
+    }
+    return {responseOf(result, Response::PAGE), true};
+}
+
+WebApi::Response WebApi::handleCalibrate(const uint8_t* data, std::size_t len, std::size_t total, ScratchArena& arena)
+{
+    Response response = Response::ACCEPTED;
+    {
+        JsonDocument body(&arena);
+        response = parseBody(body, data, len, total);
+        if (response == Response::ACCEPTED && !body.containsKey(calibrate_param))
+        {
+            response = Response::BAD_REQUEST;
+        }
+        else if (response == Response::ACCEPTED)
+        {
+            response = responseOf(controller_.createCalibrationCommand(body[calibrate_param]), Response::ACCEPTED);
+        }
+    }
+    arena.reset();
+    return response;
+}
+
+WebApi::Response WebApi::parseBody(JsonDocument& document, const uint8_t* data, std::size_t len, std::size_t total)
+{
+    if (len != total)
+    {
+        return Response::TOO_LARGE;
+    }
+    const DeserializationError error = deserializeJson(document, data, len);
+    if (error == DeserializationError::NoMemory)
+    {
+        return Response::TOO_LARGE;
+    }
+    return error ? Response::BAD_REQUEST : Response::ACCEPTED;
+}
@@ -0,0 +1,107 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#pragma once
+#include "admission_control.h"
+#include "scratch_arena.h"
+#include "shutter_controller.h"
+
+#include "Arduino.h"
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Class implementing the command requests of the web API, independent of the web server.
+///
+/// main.cpp adapts the AsyncWebServerRequest to it, tools/simulator/replay.cpp drives it with recorded requests.
+/// Only used from the async web server context.
+class WebApi
+{
+public:
+    /// @brief Struct encapsulating a query parameter, referencing the strings of the request.
+    struct Param
+    {
+        const String* name;
+        const String* value;
+    };
+
+    /// @brief Enum for the response to send.
+    enum Response
+    {
+        /// @brief The request was accepted, the index page is sent.
+        PAGE,
+        /// @brief The STOP was accepted but the page is not sent (under load), a plain "OK" is sent.
+        STOPPED,
+        /// @brief The client exhausted its tokens, an empty 429 is sent.
+        RATE_LIMITED,
+        /// @brief Too many responses in flight, an empty 503 is sent.
+        OVERLOADED,
+        /// @brief The inbox is full: the control loop is behind, an empty 503 is sent.
+        INBOX_FULL,
+        /// @brief The request was accepted, an empty 200 is sent.
+        ACCEPTED,
+        /// @brief The request named an unknown device or scene, 404 is sent.
+        NOT_FOUND,
+        /// @brief The body is not valid JSON or misses a member, 400 is sent.
+        BAD_REQUEST,
+        /// @brief The body arrived in pieces or does not fit the scratch arena, 413 is sent.
+        TOO_LARGE
+    };
+
+    /// @brief Struct encapsulating the outcome of a request.
+    struct Outcome
+    {
+        Response response;
+        /// @brief True, if the request took a slot of the admission control, released when the response is finished.
+        bool admitted;
+    };
+
+    /// @brief The number of query parameters considered.
+    static const std::size_t max_params = 8;
+
+    /// @brief  Constructor.
+    /// @param controller The controller receiving the commands.
+    /// @param admission The admission control of the web requests.
+    WebApi(ShutterController& controller, AdmissionControl& admission);
+
+    /// @brief Handles a /get request: a relative (command=), scene (scene=) or absolute (shutter_scale=) command.
+    /// A STOP bypasses the admission control, only the page is not sent under load. A malformed command is
+    /// BAD_REQUEST, an unknown device or scene NOT_FOUND, and INBOX_FULL is only returned if posting failed.
+    /// @param params The query parameters.
+    /// @param count The number of query parameters.
+    /// @param client The IPv4 address of the client.
+    /// @param now_ms The current time [ms].
+    /// @return The outcome of the request.
+    Outcome handleGet(const Param* params, std::size_t count, std::uint32_t client, unsigned long now_ms);
+
+    /// @brief Handles an /api/calibrate request, its body is a JSON object like {"calibrate":"0"}.
+    /// @param data The first piece of the body.
+    /// @param len The size of the piece.
+    /// @param total The size of the whole body.
+    /// @param arena The scratch arena of the parsed body, reset before returning.
+    /// @return ACCEPTED, NOT_FOUND, BAD_REQUEST, TOO_LARGE or INBOX_FULL.
+    Response handleCalibrate(const uint8_t* data, std::size_t len, std::size_t total, ScratchArena& arena);
+
+    /// @brief Parses a JSON request body. Only bodies arriving in one piece are parsed, the API requests are small.
+    /// @param document The parsed body, allocated from a scratch arena.
+    /// @param data The first piece of the body.
+    /// @param len The size of the piece.
+    /// @param total The size of the whole body.
+    /// @return ACCEPTED, BAD_REQUEST or TOO_LARGE.
+    static Response parseBody(JsonDocument& document, const uint8_t* data, std::size_t len, std::size_t total);
+
+private:
+    ShutterController& controller_;
+    AdmissionControl& admission_;
+};
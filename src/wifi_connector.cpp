@@ -0,0 +1,139 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "wifi_connector.h"
+
+#include <LittleFS.h>
+#include <cstring>
+
+namespace
+{
+    const char* cache_path = "/wifi.bin";
+}
+
+void WifiConnector::begin(const char* ssid, const char* password, bool use_cache)
+{
+    ssid_ = ssid;
+    password_ = password;
+    use_cache_ = use_cache;
+    // The cache replaces the SDK's own flash persistence, which would write on every begin().
+    WiFi.persistent(false);
+    WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(true);
+
+    fast_connect_ = use_cache_ && loadCache();
+    attempt_start_ms_ = millis();
+    if (!fast_connect_)
+    {
+        beginRegular();
+        return;
+    }
+    WiFi.config(IPAddress(cache_.ip), IPAddress(cache_.gateway), IPAddress(cache_.subnet), IPAddress(cache_.dns));
+    WiFi.begin(ssid_, password_, cache_.channel, cache_.bssid);
+}
+
+void WifiConnector::beginRegular()
+{
+    // Zero addresses switch back to DHCP.
+    WiFi.config(0u, 0u, 0u);
+    WiFi.begin(ssid_, password_);
+}
+
+bool WifiConnector::execute()
+{
+    const bool connected = WiFi.status() == WL_CONNECTED;
+    if (connected == connected_)
+    {
+        if (!connected && fast_connect_ && millis() - attempt_start_ms_ > fast_connect_timeout_ms_)
+        {
+            // The access point, the channel or the lease has changed.
+            fast_connect_ = false;
+            dropCache();
+            attempt_start_ms_ = millis();
+            beginRegular();
+        }
+        return false;
+    }
+
+    connected_ = connected;
+    if (connected && fast_connect_)
+    {
+        // The fallback timeout only applies to the boot attempt.
+        fast_connected_ = true;
+        fast_connect_ = false;
+    }
+    if (connected && use_cache_)
+    {
+        storeCache();
+    }
+    return connected;
+}
+
+bool WifiConnector::fastConnect() const
+{
+    return fast_connected_;
+}
+
+bool WifiConnector::loadCache()
+{
+    if (!LittleFS.exists(cache_path))
+    {
+        return false;
+    }
+    File file = LittleFS.open(cache_path, "r");
+    if (!file)
+    {
+        return false;
+    }
+    CachedParams cache;
+    const auto read = file.read(reinterpret_cast<uint8_t*>(&cache), sizeof(cache));
+    file.close();
+    if (read != sizeof(cache) || cache.version != cache_version_ || cache.ip == 0)
+    {
+        return false;
+    }
+    cache_ = cache;
+    return true;
+}
+
+void WifiConnector::storeCache()
+{
+    CachedParams cache;
+    cache.version = cache_version_;
+    memcpy(cache.bssid, WiFi.BSSID(), sizeof(cache.bssid));
+    cache.channel = WiFi.channel();
+    cache.ip = WiFi.localIP();
+    cache.gateway = WiFi.gatewayIP();
+    cache.subnet = WiFi.subnetMask();
+    cache.dns = WiFi.dnsIP();
+    if (memcmp(&cache, &cache_, sizeof(cache)) == 0)
+    {
+        return;
+    }
+
+    File file = LittleFS.open(cache_path, "w");
+    if (!file)
+    {
+        return;
+    }
+    file.write(reinterpret_cast<const uint8_t*>(&cache), sizeof(cache));
+    file.close();
+    cache_ = cache;
+}
+
+void WifiConnector::dropCache()
+{
+    cache_ = CachedParams();
+    LittleFS.remove(cache_path);
+}
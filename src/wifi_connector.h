@@ -0,0 +1,89 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <ESP8266WiFi.h>
+#include <cstdint>
+
+/// @brief Class connecting to the WiFi network in the background.
+///
+/// The BSSID, channel and IP configuration of the last successful connection are cached in LittleFS,
+/// so a reconnection after a reboot skips the scan and DHCP. If the cached parameters do not lead to
+/// a connection in time, the cache is dropped and a regular connection is made.
+class WifiConnector
+{
+public:
+    /// @brief Starts connecting, without waiting for the connection.
+    /// @param ssid The SSID of the network, must outlive the connector.
+    /// @param password The password of the network, must outlive the connector.
+    /// @param use_cache True, if the cached parameters may be used (the filesystem is available).
+    void begin(const char* ssid, const char* password, bool use_cache);
+
+    /// @brief Follows the connection, updates the cache once connected.
+    /// @return True, if the connection was established in this call.
+    bool execute();
+
+    /// @brief Returns if the boot connection was established with the cached parameters.
+    /// @return True, if the fast path succeeded.
+    bool fastConnect() const;
+
+private:
+    /// @brief Struct of the cached connection parameters, stored as is.
+    struct CachedParams
+    {
+        uint8_t version = 0;
+        uint8_t bssid[6] = {};
+        /// @brief Keeps the struct free of padding, so it can be compared with memcmp.
+        uint8_t reserved = 0;
+        int32_t channel = 0;
+        uint32_t ip = 0;
+        uint32_t gateway = 0;
+        uint32_t subnet = 0;
+        uint32_t dns = 0;
+    };
+
+    /// @brief Starts a regular connection (scan, DHCP).
+    void beginRegular();
+    /// @brief Loads the cached parameters.
+    /// @return True, if valid parameters were found.
+    bool loadCache();
+    /// @brief Stores the parameters of the current connection, if they differ from the cache.
+    void storeCache();
+    /// @brief Removes the cached parameters.
+    void dropCache();
+
+    /// @brief The version of the cache format.
+    static const uint8_t cache_version_ = 1;
+    /// @brief The time allowed for the fast path before falling back to a regular connection. [ms]
+    static const unsigned long fast_connect_timeout_ms_ = 4000;
+
+    /// @brief The SSID of the network.
+    const char* ssid_ = nullptr;
+    /// @brief The password of the network.
+    const char* password_ = nullptr;
+    /// @brief The cached parameters.
+    CachedParams cache_;
+    /// @brief True, if the cache may be used.
+    bool use_cache_ = false;
+    /// @brief True, if the boot attempt uses the cached parameters and is still in progress. Later reconnects are
+    /// left to the SDK's auto reconnect.
+    bool fast_connect_ = false;
+    /// @brief True, if the boot connection was established with the cached parameters.
+    bool fast_connected_ = false;
+    /// @brief True, if the station is connected.
+    bool connected_ = false;
+    /// @brief The start time of the current connection attempt. [ms]
+    unsigned long attempt_start_ms_ = 0;
+};
@@ -0,0 +1,138 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Runs one controller node on the host, to test the coordination of several controllers on loopback.
+//
+// Every node serves the binary UDP control protocol (see tools/udp_client.py) and coordinates with the other nodes
+// over loopback; the RF frames are not transmitted anywhere. The node prints the owners and the state it serves
+// whenever they change.
+//
+// Build (from the repository root):
+//   g++ -std=gnu++17 -O2 -Itools/simulator/shim -Isrc tools/simulator/cluster_host.cpp tools/simulator/shim/*.cpp
+//       src/cluster_node.cpp src/cluster_protocol.cpp src/command.cpp src/duplicate_filter.cpp src/event_trace.cpp
+//       src/rf_protocol.cpp src/scene.cpp src/shutter.cpp src/shutter_controller.cpp src/state_snapshot.cpp
+//       src/transmitter.cpp src/travel_profile.cpp src/udp_protocol.cpp src/udp_server.cpp -o cluster_host
+// Usage: ./cluster_host --node 1 --mask 3 [--nodes 3] [--cluster-port 5100] [--command-port 5005]
+//   Node n listens on cluster-port + n - 1 and command-port + n - 1, --mask is the set of reachable shutters.
+// Example: three nodes, sharing shutter 1, then a command to node 3 for shutter 0 (owned by node 1):
+//   ./cluster_host --node 1 --mask 3 & ./cluster_host --node 2 --mask 14 & ./cluster_host --node 3 --mask 8 &
+//   python tools/udp_client.py 127.0.0.1 down --devices 0 --port 5007
+
+#include "cluster_node.h"
+#include "udp_server.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+namespace
+{
+    /// @brief The control tick of main.cpp [ms].
+    const unsigned long exec_period_ms = 20;
+
+    struct Options
+    {
+        int node = 1;
+        int mask = 0b1111;
+        int nodes = 3;
+        int cluster_port = 5100;
+        int command_port = 5005;
+    };
+
+    Options parseOptions(int argc, char** argv)
+    {
+        Options options;
+        for (int i = 1; i + 1 < argc; i += 2)
+        {
+            const int value = atoi(argv[i + 1]);
+            if (!strcmp(argv[i], "--node")) options.node = value;
+            else if (!strcmp(argv[i], "--mask")) options.mask = value;
+            else if (!strcmp(argv[i], "--nodes")) options.nodes = value;
+            else if (!strcmp(argv[i], "--cluster-port")) options.cluster_port = value;
+            else if (!strcmp(argv[i], "--command-port")) options.command_port = value;
+            else
+            {
+                fprintf(stderr, "unknown option %s\n", argv[i]);
+                exit(1);
+            }
+        }
+        return options;
+    }
+
+    std::string describe(const ClusterNode& cluster, const ShutterController& controller)
+    {
+        std::string description = "peers " + std::to_string(cluster.peers()) + " |";
+        for (int device = 0; device < Shutter::Device::ALL; ++device)
+        {
+            const auto& state = controller.stateSnapshot().state(device);
+            description += " " + std::to_string(device) + ": owner " +
+                std::to_string(cluster.ownerOf(static_cast<Shutter::Device>(device))) + " at " +
+                std::to_string(state.position) + (state.queued > 0 ? " (moving)" : "") + " |";
+        }
+        return description + " forwarded " + std::to_string(cluster.forwarded()) + " failed " +
+            std::to_string(cluster.forwardFailures());
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const Options options = parseOptions(argc, argv);
+    const uint16_t offset = static_cast<uint16_t>(options.node - 1);
+
+    ShutterController controller(1);
+    UdpServer udp_server(controller, options.command_port + offset);
+    ClusterNode cluster(controller, {static_cast<uint8_t>(options.node), static_cast<uint8_t>(options.mask),
+        static_cast<uint16_t>(options.cluster_port + offset), IPAddress(127, 0, 0, 1),
+        static_cast<uint8_t>(options.nodes), static_cast<uint16_t>(options.cluster_port)});
+    udp_server.begin();
+    cluster.begin();
+
+    // The virtual clock follows the real time, the transmissions only advance it. The forwarder waits for the
+    // acknowledgement of another process.
+    Shim::setRealTime(true);
+    const auto start = std::chrono::steady_clock::now();
+    unsigned long prev_exec_time_ms = 0;
+    std::string last_description;
+    while (true)
+    {
+        const auto real_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        if (Shim::now() < static_cast<uint64_t>(real_us))
+        {
+            Shim::advance(real_us - Shim::now());
+        }
+
+        udp_server.execute();
+        cluster.execute();
+        const auto time_ms = millis();
+        if (time_ms - prev_exec_time_ms > exec_period_ms)
+        {
+            controller.execute();
+            prev_exec_time_ms = time_ms;
+        }
+
+        const auto description = describe(cluster, controller);
+        if (description != last_description)
+        {
+            printf("node %d at %6.1f s: %s\n", options.node, millis() / 1000.0, description.c_str());
+            fflush(stdout);
+            last_description = description;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
@@ -0,0 +1,119 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "motor_model.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    /// @brief The share of the full travel time spent until a progress (0..1): (1 - k) x + k x^2.
+    double timeShare(double curve, double progress)
+    {
+        return (1 - curve) * progress + curve * progress * progress;
+    }
+
+    /// @brief The inverse of timeShare().
+    double progressAt(double curve, double share)
+    {
+        if (share >= 1)
+        {
+            return 1;
+        }
+        if (curve <= 0)
+        {
+            return share;
+        }
+        return (-(1 - curve) + std::sqrt((1 - curve) * (1 - curve) + 4 * curve * share)) / (2 * curve);
+    }
+}
+
+MotorModel::MotorModel(const MotorParams& params, double position): params_(params)
+{
+    Motion standing;
+    standing.start_position = position;
+    motions_.push_back(standing);
+}
+
+void MotorModel::receive(Instruction instruction, uint64_t time_us, uint64_t latency_us)
+{
+    if (instruction != Instruction::UP && instruction != Instruction::DOWN && instruction != Instruction::STOP)
+    {
+        return;
+    }
+    while (motions_.size() > 1 && motions_[1].start_us <= time_us)
+    {
+        motions_.erase(motions_.begin());
+    }
+
+    // The reactions keep the order of the receptions.
+    Motion next;
+    next.direction = instruction;
+    next.start_us = std::max(time_us + latency_us, motions_.back().start_us);
+    const Motion& previous = motionAt(next.start_us);
+    next.start_position = positionOf(previous, next.start_us);
+    next.stop_us = instruction == Instruction::STOP ? std::min(previous.stop_us, next.start_us) : endOf(next);
+    motions_.push_back(next);
+}
+
+const MotorModel::Motion& MotorModel::motionAt(uint64_t time_us) const
+{
+    for (auto motion = motions_.rbegin(); motion != motions_.rend(); ++motion)
+    {
+        if (motion->start_us <= time_us)
+        {
+            return *motion;
+        }
+    }
+    return motions_.front();
+}
+
+double MotorModel::positionOf(const Motion& motion, uint64_t time_us) const
+{
+    if (motion.direction == Instruction::STOP || time_us <= motion.start_us)
+    {
+        return motion.start_position;
+    }
+    const double full_us = 1000 * (motion.direction == Instruction::DOWN ? params_.down_ms : params_.up_ms);
+    // The progress is measured in the direction of the travel.
+    const double start_progress = motion.direction == Instruction::DOWN ?
+        motion.start_position / 100 : 1 - motion.start_position / 100;
+    const double share = timeShare(params_.curve, start_progress) + (time_us - motion.start_us) / full_us;
+    const double progress = progressAt(params_.curve, share);
+    return motion.direction == Instruction::DOWN ? 100 * progress : 100 * (1 - progress);
+}
+
+uint64_t MotorModel::endOf(const Motion& motion) const
+{
+    const double full_us = 1000 * (motion.direction == Instruction::DOWN ? params_.down_ms : params_.up_ms);
+    const double start_progress = motion.direction == Instruction::DOWN ?
+        motion.start_position / 100 : 1 - motion.start_position / 100;
+    return motion.start_us + static_cast<uint64_t>(std::ceil((1 - timeShare(params_.curve, start_progress)) * full_us));
+}
+
+double MotorModel::position(uint64_t time_us) const
+{
+    return positionOf(motionAt(time_us), time_us);
+}
+
+bool MotorModel::moving(uint64_t time_us) const
+{
+    return motions_.back().start_us > time_us || time_us < motionAt(time_us).stop_us;
+}
+
+uint64_t MotorModel::stoppedAt(uint64_t time_us) const
+{
+    return motionAt(time_us).stop_us;
+}
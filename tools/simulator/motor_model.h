@@ -0,0 +1,91 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "instruction.h"
+
+#include <cstdint>
+#include <vector>
+
+/// @brief Struct containing the physical parameters of a simulated shutter motor.
+struct MotorParams
+{
+    /// @brief The full travel time upwards [ms].
+    double up_ms = 25000;
+    /// @brief The full travel time downwards [ms].
+    double down_ms = 25000;
+    /// @brief The delay between receiving a frame and the motor reacting [ms].
+    double start_latency_ms = 0;
+    /// @brief The non-linearity of the travel k (0 <= k < 1): the speed drops to (1 - k) / (1 + k) of the initial
+    /// speed along the travel, 0 is a constant speed.
+    double curve = 0;
+};
+
+/// @brief Class simulating a shutter motor: reacts to the received instructions after the start latency, moves with
+/// a non-linear speed and stops at the end positions.
+class MotorModel
+{
+public:
+    /// @brief Constructor.
+    /// @param params The physical parameters.
+    /// @param position The initial position (0: up, 100: down).
+    MotorModel(const MotorParams& params, double position);
+
+    /// @brief Processes a received instruction.
+    /// @param instruction The instruction.
+    /// @param time_us The time of the reception [us], not earlier than the previous one.
+    /// @param latency_us The reaction latency of this reception [us].
+    void receive(Instruction instruction, uint64_t time_us, uint64_t latency_us);
+
+    /// @brief Returns the position.
+    /// @param time_us The time [us], not earlier than the last reception.
+    /// @return The position (0: up, 100: down).
+    double position(uint64_t time_us) const;
+
+    /// @brief Returns if the motor moves or is about to react to an instruction.
+    /// @param time_us The time [us], not earlier than the last reception.
+    /// @return True, if the motor moves or an instruction is pending.
+    bool moving(uint64_t time_us) const;
+
+    /// @brief Returns the time the motor stopped.
+    /// @param time_us The time [us], at which the motor does not move.
+    /// @return The end of the last motion [us].
+    uint64_t stoppedAt(uint64_t time_us) const;
+
+private:
+    /// @brief Struct encapsulating the motion started by an instruction.
+    struct Motion
+    {
+        /// @brief UP, DOWN, or STOP when standing.
+        Instruction direction = Instruction::STOP;
+        /// @brief The start of the motion [us].
+        uint64_t start_us = 0;
+        /// @brief The position at the start.
+        double start_position = 0;
+        /// @brief The time the motor stops: at the end stop, or when standing, the end of the previous motion [us].
+        uint64_t stop_us = 0;
+    };
+
+    /// @brief Returns the motion in effect at a time.
+    const Motion& motionAt(uint64_t time_us) const;
+    /// @brief Returns the position reached by a motion.
+    double positionOf(const Motion& motion, uint64_t time_us) const;
+    /// @brief Returns the time a motion reaches its end stop [us].
+    uint64_t endOf(const Motion& motion) const;
+
+    MotorParams params_;
+    /// @brief The current motion, followed by the reactions to the instructions received during the latency.
+    std::vector<Motion> motions_;
+};
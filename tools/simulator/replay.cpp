@@ -0,0 +1,654 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Replays a timestamped trace of web requests against the controller, on the virtual clock of the host build.
+//
+// Every request goes through WebApi, the request handling of main.cpp, and the control tick runs every 20 ms like
+// loop() does; the transmissions block the loop for their real duration. The report covers the responses, the
+// latency from the request to the first frame acting on it, the growth of the inbox and command queues, the share
+// of time the transmitter was busy, and the requests which were dropped or merged into a later one.
+//
+// Trace format, one request per line ('#' starts a comment), the times are relative to the first request:
+//   <seconds> [<client ip>] GET /get?command=3,up
+//   <seconds> [<client ip>] POST /api/calibrate {"calibrate":"0"}
+// Access logs in the common / combined log format are accepted as is, but they do not contain the POST bodies:
+//   192.168.1.20 - - [12/Mar/2024:07:30:01 +0100] "GET /get?shutter_scale=40&living_room_door=on HTTP/1.1" 200 1534
+//
+// Build (from the repository root):
+//   g++ -std=gnu++17 -O2 -Itools/simulator/shim -Isrc tools/simulator/replay.cpp tools/simulator/shim/arduino_shim.cpp
+//       tools/simulator/shim/json_shim.cpp src/admission_control.cpp src/command.cpp src/duplicate_filter.cpp
+//       src/event_trace.cpp src/rf_protocol.cpp src/scene.cpp src/scratch_arena.cpp src/shutter.cpp
+//       src/shutter_controller.cpp src/state_snapshot.cpp src/transmitter.cpp src/travel_profile.cpp src/web_api.cpp
+//       -o replay
+// Usage: ./replay <trace> [--speed 0] [--response-ms 150] [--report-s 0]
+//   --speed: 0 replays as fast as possible, N paces the replay at N times the real time (1: real time).
+//   --response-ms: the time an admitted response stays in flight (streaming the page).
+//   --report-s: prints the requests, queue peak and transmitter share of every interval of this length (0: off).
+
+#include "admission_control.h"
+#include "event_trace.h"
+#include "shutter_controller.h"
+#include "web_api.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    /// @brief The replay options.
+    struct Options
+    {
+        const char* trace = nullptr;
+        double speed = 0;
+        double response_ms = 150;
+        double report_s = 0;
+    };
+
+    /// @brief The control tick of main.cpp [ms].
+    const unsigned long exec_period_ms = 20;
+    const int shutter_count = Shutter::Device::ALL;
+    /// @brief The virtual time of the first request, the controller has settled by then [us].
+    const uint64_t start_us = 1000000;
+
+    /// @brief A request of the trace.
+    struct TraceRequest
+    {
+        /// @brief The time relative to the first request [us].
+        uint64_t time_us = 0;
+        uint32_t client = 0;
+        std::string method;
+        std::string path;
+        /// @brief The decoded query parameters.
+        std::vector<std::pair<String, String>> params;
+        std::string body;
+    };
+
+    /// @brief The counters of the responses.
+    struct Responses
+    {
+        std::array<unsigned long, WebApi::Response::TOO_LARGE + 1> count {};
+        /// @brief The requests of other endpoints, not replayed.
+        unsigned long other = 0;
+        /// @brief The POST requests of an access log, without their body.
+        unsigned long no_body = 0;
+    };
+
+    /// @brief The fate of the requests of a shutter.
+    struct Commands
+    {
+        /// @brief The requests whose first frame was sent.
+        unsigned long transmitted = 0;
+        /// @brief The requests superseded by a later one before their frame was sent.
+        unsigned long merged = 0;
+        /// @brief The requests which needed no frame (e.g. already there, or suppressed as duplicates).
+        unsigned long absorbed = 0;
+        /// @brief The requests posted to a full inbox (503).
+        unsigned long dropped = 0;
+        /// @brief The request to first frame latencies [ms].
+        std::vector<double> latencies_ms;
+    };
+
+    /// @brief The statistics of a report interval.
+    struct Interval
+    {
+        unsigned long requests = 0;
+        std::size_t peak_queued = 0;
+        uint64_t airtime_us = 0;
+    };
+
+    double percentile(std::vector<double>& values, double share)
+    {
+        if (values.empty())
+        {
+            return 0;
+        }
+        std::sort(values.begin(), values.end());
+        const std::size_t index = std::min(values.size() - 1, static_cast<std::size_t>(share * values.size()));
+        return values[index];
+    }
+
+    void printDistribution(const char* name, std::vector<double> values, const char* unit)
+    {
+        double sum = 0;
+        for (const auto value : values)
+        {
+            sum += value;
+        }
+        printf("%-22s mean %7.2f  p50 %7.2f  p90 %7.2f  p99 %7.2f  max %7.2f %s\n", name,
+            values.empty() ? 0 : sum / values.size(), percentile(values, 0.5), percentile(values, 0.9),
+            percentile(values, 0.99), percentile(values, 1.0), unit);
+    }
+
+    Options parseOptions(int argc, char** argv)
+    {
+        Options options;
+        int i = 1;
+        if (argc > 1 && argv[1][0] != '-')
+        {
+            options.trace = argv[1];
+            i = 2;
+        }
+        for (; i + 1 < argc; i += 2)
+        {
+            const double value = atof(argv[i + 1]);
+            if (!strcmp(argv[i], "--speed")) options.speed = value;
+            else if (!strcmp(argv[i], "--response-ms")) options.response_ms = value;
+            else if (!strcmp(argv[i], "--report-s")) options.report_s = value;
+            else
+            {
+                fprintf(stderr, "unknown option %s\n", argv[i]);
+                exit(1);
+            }
+        }
+        if (!options.trace || i != argc)
+        {
+            fprintf(stderr, "usage: %s <trace> [--speed 0] [--response-ms 150] [--report-s 0]\n", argv[0]);
+            exit(1);
+        }
+        return options;
+    }
+
+    uint32_t parseAddress(const char* text)
+    {
+        unsigned a = 0, b = 0, c = 0, d = 0;
+        if (sscanf(text, "%u.%u.%u.%u", &a, &b, &c, &d) != 4)
+        {
+            return 0;
+        }
+        // The byte order of IPAddress.
+        return a | (b << 8) | (c << 16) | (static_cast<uint32_t>(d) << 24);
+    }
+
+    std::string decodeUrl(const std::string& text)
+    {
+        std::string decoded;
+        for (std::size_t i = 0; i < text.size(); ++i)
+        {
+            if (text[i] == '+')
+            {
+                decoded += ' ';
+            }
+            else if (text[i] == '%' && i + 2 < text.size())
+            {
+                decoded += static_cast<char>(strtol(text.substr(i + 1, 2).c_str(), nullptr, 16));
+                i += 2;
+            }
+            else
+            {
+                decoded += text[i];
+            }
+        }
+        return decoded;
+    }
+
+    void parseTarget(const std::string& target, TraceRequest& request)
+    {
+        const auto query = target.find('?');
+        request.path = target.substr(0, query);
+        if (query == std::string::npos)
+        {
+            return;
+        }
+        std::size_t begin = query + 1;
+        while (begin < target.size())
+        {
+            const auto end = std::min(target.find('&', begin), target.size());
+            const auto pair = target.substr(begin, end - begin);
+            const auto equals = pair.find('=');
+            request.params.emplace_back(String(decodeUrl(pair.substr(0, equals)).c_str()),
+                String(equals == std::string::npos ? "" : decodeUrl(pair.substr(equals + 1)).c_str()));
+            begin = end + 1;
+        }
+    }
+
+    /// @brief Parses the time of an access log entry ("12/Mar/2024:07:30:01 +0100").
+    /// @return The seconds since the epoch, negative if the time is malformed.
+    double parseLogTime(const char* text)
+    {
+        static const char* months = "JanFebMarAprMayJunJulAugSepOctNovDec";
+        int day = 0, year = 0, hour = 0, minute = 0, second = 0, zone = 0;
+        char month[4] = {};
+        if (sscanf(text, "%d/%3s/%d:%d:%d:%d %d", &day, month, &year, &hour, &minute, &second, &zone) != 7)
+        {
+            return -1;
+        }
+        const char* found = strstr(months, month);
+        if (!found)
+        {
+            return -1;
+        }
+        // Days from the civil date (proleptic Gregorian calendar).
+        int m = static_cast<int>(found - months) / 3 + 1;
+        const int y = year - (m <= 2);
+        const int era = (y >= 0 ? y : y - 399) / 400;
+        const int year_of_era = y - era * 400;
+        const int day_of_year = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        const int day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+        const double days = era * 146097.0 + day_of_era - 719468;
+        const int zone_s = (zone / 100) * 3600 + (zone % 100) * 60;
+        return days * 86400 + hour * 3600 + minute * 60 + second - zone_s;
+    }
+
+    /// @brief Parses a line of the trace.
+    /// @return True, if the line contained a request; the time is absolute until the trace is loaded.
+    bool parseLine(const std::string& line, TraceRequest& request, double& time_s)
+    {
+        const auto quote = line.find('"');
+        const auto bracket = line.find('[');
+        if (quote != std::string::npos && bracket != std::string::npos && bracket < quote)
+        {
+            // Common log format: <ip> <ident> <user> [<time>] "<method> <target> <protocol>" ...
+            char method[16] = {};
+            char target[2048] = {};
+            time_s = parseLogTime(line.c_str() + bracket + 1);
+            if (time_s < 0 || sscanf(line.c_str() + quote + 1, "%15s %2047s", method, target) != 2)
+            {
+                return false;
+            }
+            request.client = parseAddress(line.c_str());
+            request.method = method;
+            parseTarget(target, request);
+            return true;
+        }
+
+        char first[64] = {};
+        char second[2048] = {};
+        char third[2048] = {};
+        int consumed = 0;
+        const int fields = sscanf(line.c_str(), "%lf %63s %2047s %2047s%n", &time_s, first, second, third, &consumed);
+        if (fields < 3)
+        {
+            return false;
+        }
+        const bool has_client = fields == 4 && strchr(first, '.') && isdigit(static_cast<unsigned char>(first[0]));
+        if (!has_client)
+        {
+            // No client: the method and the target were read into the first two fields.
+            sscanf(line.c_str(), "%lf %63s %2047s%n", &time_s, first, second, &consumed);
+            request.client = parseAddress("192.168.1.100");
+            request.method = first;
+            parseTarget(second, request);
+        }
+        else
+        {
+            request.client = parseAddress(first);
+            request.method = second;
+            parseTarget(third, request);
+        }
+        const auto body = line.find_first_not_of(" \t", consumed);
+        if (body != std::string::npos)
+        {
+            request.body = line.substr(body);
+        }
+        return true;
+    }
+
+    std::vector<TraceRequest> loadTrace(const char* path)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            fprintf(stderr, "cannot open %s\n", path);
+            exit(1);
+        }
+        std::vector<TraceRequest> requests;
+        std::vector<double> times_s;
+        std::string line;
+        unsigned long line_number = 0;
+        while (std::getline(file, line))
+        {
+            ++line_number;
+            const auto start = line.find_first_not_of(" \t\r");
+            if (start == std::string::npos || line[start] == '#')
+            {
+                continue;
+            }
+            TraceRequest request;
+            double time_s = 0;
+            if (!parseLine(line, request, time_s))
+            {
+                fprintf(stderr, "%s:%lu: skipping unparsable line\n", path, line_number);
+                continue;
+            }
+            requests.push_back(std::move(request));
+            times_s.push_back(time_s);
+        }
+
+        // Access logs are ordered by the completion of the requests, the replay by their arrival.
+        std::vector<std::size_t> order(requests.size());
+        for (std::size_t i = 0; i < order.size(); ++i)
+        {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return times_s[a] < times_s[b]; });
+        std::vector<TraceRequest> sorted;
+        sorted.reserve(requests.size());
+        for (const auto i : order)
+        {
+            requests[i].time_us = static_cast<uint64_t>(1e6 * (times_s[i] - times_s[order.front()]));
+            sorted.push_back(std::move(requests[i]));
+        }
+        return sorted;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const Options options = parseOptions(argc, argv);
+    const auto trace = loadTrace(options.trace);
+    if (trace.empty())
+    {
+        fprintf(stderr, "no requests in %s\n", options.trace);
+        return 1;
+    }
+
+    ShutterController controller(1);
+    AdmissionControl admission;
+    WebApi web_api(controller, admission);
+    ScratchArena scratch;
+
+    std::array<int, 256> device_index;
+    device_index.fill(-1);
+    for (int device = 0; device < shutter_count; ++device)
+    {
+        device_index[controller.getShutter(static_cast<Shutter::Device>(device)).deviceId()] = device;
+    }
+
+    Responses responses;
+    Commands commands;
+    // The arrival times of the requests of each shutter waiting for their first frame [us].
+    std::array<std::vector<uint64_t>, shutter_count> pending;
+    // The release times of the admitted responses in flight [us].
+    std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t>> in_flight;
+    std::vector<Interval> intervals;
+    const uint64_t interval_us = static_cast<uint64_t>(1e6 * options.report_s);
+    auto interval = [&](uint64_t time_us) -> Interval&
+    {
+        const std::size_t index = interval_us > 0 ? (time_us - start_us) / interval_us : 0;
+        if (intervals.size() <= index)
+        {
+            intervals.resize(index + 1);
+        }
+        return intervals[index];
+    };
+
+    // The events are drained after every step, so the 32 bit event times are extended with the virtual clock.
+    uint32_t next_event = EventTrace::recorded();
+    unsigned long lost_events = 0;
+    uint64_t frame_start_us = 0;
+    uint64_t airtime_us = 0;
+    bool track_requests = true;
+    auto drainEvents = [&]()
+    {
+        const uint32_t recorded = EventTrace::recorded();
+        if (recorded - next_event > EventTrace::capacity)
+        {
+            lost_events += recorded - next_event - EventTrace::capacity;
+            next_event = EventTrace::oldest(recorded);
+        }
+        const uint64_t now_us = Shim::now();
+        for (; next_event != recorded; ++next_event)
+        {
+            const auto& event = EventTrace::at(next_event);
+            const uint64_t time_us = now_us - static_cast<uint32_t>(static_cast<uint32_t>(now_us) - event.time_us);
+            const int device = device_index[event.device];
+            switch (event.type)
+            {
+            case EventTrace::Type::REQUEST_RECEIVED:
+            {
+                if (!track_requests || event.arg == Request::Type::RUN_SCENE || event.arg == Request::Type::LOAD_SCENE)
+                {
+                    break;
+                }
+                // A request without a device commands every shutter.
+                for (int target = 0; target < shutter_count; ++target)
+                {
+                    if (device < 0 || device == target)
+                    {
+                        pending[target].push_back(time_us);
+                    }
+                }
+                break;
+            }
+            case EventTrace::Type::COMMAND_EXECUTING:
+                if (device >= 0 && !pending[device].empty())
+                {
+                    // The latest request is served, the earlier ones were merged into it.
+                    ++commands.transmitted;
+                    commands.merged += pending[device].size() - 1;
+                    commands.latencies_ms.push_back((time_us - pending[device].back()) / 1000.0);
+                    pending[device].clear();
+                }
+                break;
+            case EventTrace::Type::FRAME_START:
+                frame_start_us = time_us;
+                break;
+            case EventTrace::Type::FRAME_END:
+                airtime_us += time_us - frame_start_us;
+                if (interval_us > 0)
+                {
+                    interval(frame_start_us).airtime_us += time_us - frame_start_us;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    };
+
+    const auto wall_start = std::chrono::steady_clock::now();
+    auto pace = [&]()
+    {
+        if (options.speed <= 0)
+        {
+            return;
+        }
+        const auto wall_us = static_cast<int64_t>((Shim::now() - start_us) / options.speed);
+        std::this_thread::sleep_until(wall_start + std::chrono::microseconds(wall_us));
+    };
+
+    Shim::advance(start_us);
+    const uint64_t end_us = start_us + trace.back().time_us;
+    std::size_t next_request = 0;
+    std::size_t posted_since_tick = 0;
+    std::size_t peak_posted = 0;
+    std::vector<double> queued_samples;
+    std::size_t peak_queued = 0;
+    uint64_t blocked_us = 0;
+    unsigned long prev_exec_time_ms = millis();
+    // Runs until the last request and every command it caused are finished.
+    while (true)
+    {
+        bool busy = false;
+        for (int device = 0; device < shutter_count; ++device)
+        {
+            busy = busy || controller.getShutter(static_cast<Shutter::Device>(device)).busy();
+        }
+        if (next_request == trace.size() && !busy && Shim::now() > end_us)
+        {
+            break;
+        }
+
+        // loop(): the next control tick, request or finished response, whichever comes first.
+        uint64_t wake_us = 1000ULL * (prev_exec_time_ms + exec_period_ms + 1);
+        if (next_request < trace.size())
+        {
+            wake_us = std::min(wake_us, start_us + trace[next_request].time_us);
+        }
+        if (!in_flight.empty())
+        {
+            wake_us = std::min(wake_us, in_flight.top());
+        }
+        if (Shim::now() < wake_us)
+        {
+            Shim::advance(wake_us - Shim::now());
+        }
+        pace();
+
+        while (!in_flight.empty() && in_flight.top() <= Shim::now())
+        {
+            in_flight.pop();
+            admission.release();
+        }
+
+        while (next_request < trace.size() && start_us + trace[next_request].time_us <= Shim::now())
+        {
+            const auto& request = trace[next_request++];
+            ++interval(Shim::now()).requests;
+            bool admitted = false;
+            if (request.method == "GET" && request.path == "/get")
+            {
+                std::array<WebApi::Param, WebApi::max_params> params;
+                const std::size_t count = std::min(request.params.size(), params.size());
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    params[i] = {&request.params[i].first, &request.params[i].second};
+                }
+                const uint32_t before = EventTrace::recorded();
+                const auto outcome = web_api.handleGet(params.data(), count, request.client, millis());
+                ++responses.count[outcome.response];
+                admitted = outcome.admitted;
+                posted_since_tick += EventTrace::recorded() - before;
+                // The requests of a 503 response are not tracked: the posts which failed are not known.
+                track_requests = outcome.response != WebApi::Response::INBOX_FULL;
+                if (!track_requests)
+                {
+                    ++commands.dropped;
+                }
+            }
+            else if (request.method == "POST" && request.path == "/api/calibrate")
+            {
+                if (request.body.empty())
+                {
+                    ++responses.no_body;
+                    continue;
+                }
+                const uint32_t before = EventTrace::recorded();
+                const auto body = reinterpret_cast<const uint8_t*>(request.body.data());
+                const auto response = web_api.handleCalibrate(body, request.body.size(), request.body.size(), scratch);
+                ++responses.count[response];
+                posted_since_tick += EventTrace::recorded() - before;
+                if (response == WebApi::Response::INBOX_FULL)
+                {
+                    ++commands.dropped;
+                }
+            }
+            else
+            {
+                ++responses.other;
+                continue;
+            }
+            if (admitted)
+            {
+                in_flight.push(Shim::now() + static_cast<uint64_t>(1000 * options.response_ms));
+            }
+            drainEvents();
+            track_requests = true;
+        }
+
+        const auto time_ms = millis();
+        if (time_ms - prev_exec_time_ms > exec_period_ms)
+        {
+            // Transmissions advance the virtual clock, just like they block the loop on the board.
+            const uint64_t before_us = Shim::now();
+            controller.execute();
+            blocked_us += Shim::now() - before_us;
+            prev_exec_time_ms = time_ms;
+            peak_posted = std::max(peak_posted, posted_since_tick);
+            posted_since_tick = 0;
+            drainEvents();
+
+            std::size_t queued = 0;
+            for (int device = 0; device < shutter_count; ++device)
+            {
+                const auto& shutter = controller.getShutter(static_cast<Shutter::Device>(device));
+                queued += shutter.queued();
+                if (!shutter.busy() && !pending[device].empty())
+                {
+                    // Nothing left to send: the requests needed no frame (or were suppressed as duplicates).
+                    commands.absorbed += pending[device].size();
+                    pending[device].clear();
+                }
+            }
+            if (queued > 0)
+            {
+                queued_samples.push_back(queued);
+            }
+            peak_queued = std::max(peak_queued, queued);
+            if (interval_us > 0 && Shim::now() <= end_us)
+            {
+                auto& current = interval(Shim::now());
+                current.peak_queued = std::max(current.peak_queued, queued);
+            }
+        }
+    }
+
+    const double span_s = (Shim::now() - start_us) / 1e6;
+    const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    const auto& count = responses.count;
+    char speed[32] = "as fast as possible";
+    if (options.speed > 0)
+    {
+        snprintf(speed, sizeof(speed), "%gx real time", options.speed);
+    }
+    printf("replayed %zu requests spanning %.1f s in %.2f s (%s)\n", trace.size(), trace.back().time_us / 1e6, wall_s,
+        speed);
+    printf("responses: page %lu, stop without page %lu, calibrate accepted %lu, rate limited (429) %lu, "
+        "overloaded (503) %lu, inbox full (503) %lu, other endpoints %lu, POST without body %lu\n",
+        count[WebApi::Response::PAGE], count[WebApi::Response::STOPPED], count[WebApi::Response::ACCEPTED],
+        count[WebApi::Response::RATE_LIMITED], count[WebApi::Response::OVERLOADED], count[WebApi::Response::INBOX_FULL],
+        responses.other, responses.no_body);
+    printf("rejected requests: bad request (400) %lu, unknown device or scene (404) %lu, too large (413) %lu\n",
+        count[WebApi::Response::BAD_REQUEST], count[WebApi::Response::NOT_FOUND], count[WebApi::Response::TOO_LARGE]);
+    printf("shutter requests: transmitted %lu, merged into a later request %lu, no frame needed %lu "
+        "(duplicates suppressed %lu), dropped with 503 (inbox full) %lu\n", commands.transmitted, commands.merged,
+        commands.absorbed, controller.metrics().suppressed_duplicates, commands.dropped);
+    printDistribution("latency to first frame", commands.latencies_ms, "ms");
+    printDistribution("queued commands", queued_samples, "(ticks with a queue)");
+    printf("peak posts per tick %zu (inbox capacity 16), peak queued commands %zu\n", peak_posted, peak_queued);
+    printf("transmitter airtime %.2f s (%.3f %% of %.1f s), loop blocked %.2f s (%.3f %%)\n", airtime_us / 1e6,
+        100.0 * airtime_us / 1e6 / span_s, span_s, blocked_us / 1e6, 100.0 * blocked_us / 1e6 / span_s);
+    if (lost_events > 0)
+    {
+        printf("warning: %lu trace events were overwritten before they were read\n", lost_events);
+    }
+
+    if (interval_us > 0)
+    {
+        printf("\n%10s %9s %11s %10s\n", "from [s]", "requests", "peak queue", "airtime");
+        for (std::size_t i = 0; i < intervals.size(); ++i)
+        {
+            const auto& current = intervals[i];
+            if (current.requests == 0 && current.airtime_us == 0)
+            {
+                continue;
+            }
+            printf("%10.1f %9lu %11zu %9.2f%%\n", i * options.report_s, current.requests, current.peak_queued,
+                100.0 * current.airtime_us / interval_us);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "rf_receiver.h"
+#include "rf_params.h"
+
+RfReceiver::RfReceiver(FrameListener listener, void* context): listener_(listener), context_(context)
+{
+}
+
+void RfReceiver::onEdge(uint8_t level, uint64_t time_us)
+{
+    if (level)
+    {
+        rise_us_ = time_us;
+        return;
+    }
+
+    // The high level identifies the symbol, the low level after the last bit merges into the gap.
+    const uint64_t high_us = time_us - rise_us_;
+    if (high_us > (RFParams::one_high_receive + RFParams::sync_on) / 2)
+    {
+        synchronized_ = true;
+        bit_count_ = 0;
+        bytes_.fill(0);
+        return;
+    }
+    if (!synchronized_)
+    {
+        return;
+    }
+    const unsigned char bit = high_us > (RFParams::zero_high_receive + RFParams::one_high_receive) / 2 ? 1 : 0;
+    bytes_[bit_count_ / 8] = (bytes_[bit_count_ / 8] << 1) | bit;
+    if (++bit_count_ == 8 * frame_size)
+    {
+        synchronized_ = false;
+        onFrame(time_us);
+    }
+}
+
+void RfReceiver::onFrame(uint64_t time_us)
+{
+    ++frames_;
+    for (std::size_t i = 0; i < RFFraming::header.size(); ++i)
+    {
+        if (bytes_[i] != RFFraming::header[i])
+        {
+            ++invalid_frames_;
+            return;
+        }
+    }
+    Instruction instruction = Instruction::UNKNOWN;
+    for (std::size_t i = 0; i < RFFraming::instructions.size(); ++i)
+    {
+        if (bytes_[frame_size - 1] == RFFraming::instructions[i])
+        {
+            instruction = static_cast<Instruction>(i);
+        }
+    }
+    if (instruction == Instruction::UNKNOWN)
+    {
+        ++invalid_frames_;
+        return;
+    }
+
+    const unsigned char device_id = bytes_[frame_size - 2];
+    auto& last_frame = last_frames_[device_id];
+    const bool repetition = last_frame.instruction == instruction && time_us - last_frame.time_us < repetition_window_us;
+    last_frame.instruction = instruction;
+    last_frame.time_us = time_us;
+    if (!repetition)
+    {
+        listener_(context_, device_id, instruction, time_us);
+    }
+}
+
+unsigned long RfReceiver::frames() const
+{
+    return frames_;
+}
+
+unsigned long RfReceiver::invalidFrames() const
+{
+    return invalid_frames_;
+}
@@ -0,0 +1,78 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "instruction.h"
+
+#include <array>
+#include <cstdint>
+
+/// @brief Class decoding the frames from the level changes of the transmit pin, like the shutters' receivers.
+///
+/// Bits are classified by the length of their high level using the receive timings of RFParams. The repetitions
+/// of a frame are reported once.
+class RfReceiver
+{
+public:
+    /// @brief Receives a decoded frame.
+    using FrameListener = void (*)(void* context, unsigned char device_id, Instruction instruction, uint64_t time_us);
+
+    /// @brief Constructor.
+    /// @param listener The listener of the decoded frames.
+    /// @param context The context passed to the listener.
+    RfReceiver(FrameListener listener, void* context);
+
+    /// @brief Processes a level change of the transmit pin.
+    /// @param level The new level.
+    /// @param time_us The time of the change [us].
+    void onEdge(uint8_t level, uint64_t time_us);
+
+    /// @brief Returns the number of decoded frames, including the repetitions.
+    /// @return The number of decoded frames.
+    unsigned long frames() const;
+    /// @brief Returns the number of frames with an unknown header or instruction.
+    /// @return The number of invalid frames.
+    unsigned long invalidFrames() const;
+
+private:
+    /// @brief Decodes a complete frame.
+    /// @param time_us The end of the frame [us].
+    void onFrame(uint64_t time_us);
+
+    /// @brief The number of bytes in a frame: header, device id, instruction.
+    static const int frame_size = 5;
+    /// @brief Repetitions of the same frame within this time are reported once [us].
+    static const uint64_t repetition_window_us = 200000;
+
+    FrameListener listener_;
+    void* context_;
+    /// @brief The time of the last rising edge [us].
+    uint64_t rise_us_ = 0;
+    /// @brief True, after a synchronization pattern.
+    bool synchronized_ = false;
+    /// @brief The number of received bits of the frame.
+    int bit_count_ = 0;
+    /// @brief The received bytes of the frame.
+    std::array<unsigned char, frame_size> bytes_ {};
+    /// @brief The last reported frame of every device id, to suppress the repetitions.
+    struct LastFrame
+    {
+        Instruction instruction = Instruction::UNKNOWN;
+        uint64_t time_us = 0;
+    };
+    std::array<LastFrame, 256> last_frames_;
+    unsigned long frames_ = 0;
+    unsigned long invalid_frames_ = 0;
+};
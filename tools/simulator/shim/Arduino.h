@@ -0,0 +1,76 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Minimal host implementation of the Arduino API used by the controller sources, driven by a virtual clock.
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+
+#define HIGH 1
+#define LOW 0
+#define OUTPUT 1
+#define FUNCTION_3 3
+
+typedef uint8_t byte;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void digitalWrite(uint8_t pin, uint8_t level);
+void pinMode(uint8_t pin, uint8_t mode);
+void yield();
+
+class String
+{
+public:
+    String(const char* s = "") : s_(s) {}
+    String(int value) : s_(std::to_string(value)) {}
+    String(unsigned value) : s_(std::to_string(value)) {}
+    String(unsigned long value) : s_(std::to_string(value)) {}
+    char operator[](unsigned i) const { return i < s_.size() ? s_[i] : 0; }
+    bool operator==(const char* other) const { return s_ == other; }
+    bool operator==(const String& other) const { return s_ == other.s_; }
+    bool operator!=(const char* other) const { return s_ != other; }
+    String operator+(const String& other) const { String result; result.s_ = s_ + other.s_; return result; }
+    String& operator+=(const String& other) { s_ += other.s_; return *this; }
+    long toInt() const { return atol(s_.c_str()); }
+    const char* c_str() const { return s_.c_str(); }
+    unsigned length() const { return s_.size(); }
+    bool startsWith(const char* prefix) const { return s_.rfind(prefix, 0) == 0; }
+
+private:
+    std::string s_;
+};
+
+/// @brief The virtual clock and the pin monitor of the simulation.
+namespace Shim
+{
+    /// @brief Receives every level change of an output pin.
+    using PinListener = void (*)(void* context, uint8_t pin, uint8_t level, uint64_t time_us);
+
+    /// @brief Returns the virtual time [us], without the 32 bit wrap-around of micros().
+    uint64_t now();
+    /// @brief Advances the virtual time.
+    void advance(uint64_t us);
+    /// @brief Sets the listener of the pin level changes.
+    void setPinListener(PinListener listener, void* context);
+    /// @brief Makes delay() also sleep in real time, for the waits on other processes (e.g. an acknowledgement).
+    void setRealTime(bool real_time);
+}
@@ -0,0 +1,135 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Host implementation of the ArduinoJson 7 subset used by the controller sources: a document holding a flat object of
+// string, number, boolean and null members. Every member is allocated from the allocator of the document, so a full
+// scratch arena fails the parsing with NoMemory like the variant pool of the library does. Nested values are rejected.
+#pragma once
+
+#include "Arduino.h"
+
+#include <cstddef>
+
+namespace ArduinoJson
+{
+    class Allocator
+    {
+    public:
+        virtual void* allocate(size_t size) = 0;
+        virtual void deallocate(void* ptr) = 0;
+        virtual void* reallocate(void* ptr, size_t new_size) = 0;
+
+    protected:
+        ~Allocator() = default;
+    };
+}
+
+class DeserializationError
+{
+public:
+    enum Code
+    {
+        Ok,
+        EmptyInput,
+        IncompleteInput,
+        InvalidInput,
+        NoMemory,
+        TooDeep
+    };
+
+    DeserializationError(Code code = Ok) : code_(code) {}
+    explicit operator bool() const { return code_ != Ok; }
+    bool operator==(Code code) const { return code_ == code; }
+    bool operator!=(Code code) const { return code_ != code; }
+    Code code() const { return code_; }
+
+private:
+    Code code_;
+};
+
+class JsonVariantConst
+{
+public:
+    JsonVariantConst(const char* text = nullptr, bool string = false) : text_(text), string_(string) {}
+
+    template <typename T>
+    T as() const;
+    bool isNull() const { return text_ == nullptr; }
+    operator String() const;
+
+private:
+    /// @brief The text of the value, without the quotes of a string; nullptr for a missing or null member.
+    const char* text_;
+    bool string_;
+};
+
+template <>
+inline int JsonVariantConst::as<int>() const
+{
+    return text_ == nullptr || string_ ? 0 : (strcmp(text_, "true") == 0 ? 1 : atoi(text_));
+}
+
+template <>
+inline const char* JsonVariantConst::as<const char*>() const
+{
+    return string_ ? text_ : nullptr;
+}
+
+template <>
+inline String JsonVariantConst::as<String>() const
+{
+    // Like the library, a number or boolean is converted to its text, null to an empty string.
+    return text_ == nullptr ? String() : String(text_);
+}
+
+inline JsonVariantConst::operator String() const
+{
+    return as<String>();
+}
+
+class JsonDocument
+{
+public:
+    explicit JsonDocument(ArduinoJson::Allocator* allocator = nullptr);
+    ~JsonDocument();
+    JsonDocument(const JsonDocument&) = delete;
+    JsonDocument& operator=(const JsonDocument&) = delete;
+
+    bool isNull() const { return !object_; }
+    bool containsKey(const char* key) const { return find(key) != nullptr; }
+    JsonVariantConst operator[](const char* key) const;
+    void clear();
+
+private:
+    friend DeserializationError deserializeJson(JsonDocument& document, const uint8_t* data, size_t size);
+
+    struct Member
+    {
+        Member* next;
+        const char* key;
+        /// @brief nullptr for a null value.
+        const char* value;
+        bool string;
+    };
+
+    const Member* find(const char* key) const;
+    /// @brief Adds a member, its strings are copied next to it.
+    bool add(const std::string& key, const std::string* value, bool string);
+
+    ArduinoJson::Allocator* allocator_;
+    Member* members_ = nullptr;
+    bool object_ = false;
+};
+
+DeserializationError deserializeJson(JsonDocument& document, const uint8_t* data, size_t size);
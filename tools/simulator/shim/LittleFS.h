@@ -0,0 +1,41 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Host implementation of LittleFS: an empty, read-only filesystem. The simulated controller has no stored scenes.
+#pragma once
+
+#include "Arduino.h"
+
+class File
+{
+public:
+    size_t read(uint8_t*, size_t) { return 0; }
+    size_t write(const uint8_t*, size_t) { return 0; }
+    size_t size() const { return 0; }
+    void close() {}
+    explicit operator bool() const { return false; }
+};
+
+struct FSClass
+{
+    bool begin() { return true; }
+    File open(const char*, const char*) { return File(); }
+    File open(const String& path, const char* mode) { return open(path.c_str(), mode); }
+    bool exists(const char*) { return false; }
+    bool exists(const String&) { return false; }
+    bool remove(const char*) { return false; }
+    bool remove(const String&) { return false; }
+};
+
+extern FSClass LittleFS;
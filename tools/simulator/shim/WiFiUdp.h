@@ -0,0 +1,46 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Host implementation of WiFiUDP on a non-blocking POSIX socket, for running several controllers on loopback.
+#pragma once
+
+#include "ESP8266WiFi.h"
+
+#include <cstddef>
+#include <vector>
+
+class WiFiUDP
+{
+public:
+    ~WiFiUDP();
+    uint8_t begin(uint16_t port);
+    int parsePacket();
+    int read(uint8_t* buffer, size_t size);
+    IPAddress remoteIP() const;
+    uint16_t remotePort() const;
+    int beginPacket(IPAddress address, uint16_t port);
+    size_t write(const uint8_t* data, size_t size);
+    int endPacket();
+
+private:
+    int socket_ = -1;
+    std::vector<uint8_t> received_;
+    std::size_t read_offset_ = 0;
+    IPAddress remote_address_;
+    uint16_t remote_port_ = 0;
+    std::vector<uint8_t> sending_;
+    IPAddress send_address_;
+    uint16_t send_port_ = 0;
+};
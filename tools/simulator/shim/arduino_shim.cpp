@@ -0,0 +1,90 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "Arduino.h"
+#include "LittleFS.h"
+
+#include <chrono>
+#include <thread>
+
+FSClass LittleFS;
+
+namespace
+{
+    uint64_t now_us = 0;
+    Shim::PinListener pin_listener = nullptr;
+    void* pin_listener_context = nullptr;
+    bool real_time = false;
+}
+
+uint64_t Shim::now()
+{
+    return now_us;
+}
+
+void Shim::advance(uint64_t us)
+{
+    now_us += us;
+}
+
+void Shim::setPinListener(PinListener listener, void* context)
+{
+    pin_listener = listener;
+    pin_listener_context = context;
+}
+
+void Shim::setRealTime(bool enabled)
+{
+    real_time = enabled;
+}
+
+unsigned long millis()
+{
+    return static_cast<uint32_t>(now_us / 1000);
+}
+
+unsigned long micros()
+{
+    return static_cast<uint32_t>(now_us);
+}
+
+void delay(unsigned long ms)
+{
+    if (real_time)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+    now_us += 1000ULL * ms;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    now_us += us;
+}
+
+void digitalWrite(uint8_t pin, uint8_t level)
+{
+    if (pin_listener != nullptr)
+    {
+        pin_listener(pin_listener_context, pin, level, now_us);
+    }
+}
+
+void pinMode(uint8_t, uint8_t)
+{
+}
+
+void yield()
+{
+}
@@ -0,0 +1,267 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "ArduinoJson.h"
+
+#include <cctype>
+#include <new>
+
+namespace
+{
+    /// @brief The allocator of the documents constructed without one.
+    class HeapAllocator : public ArduinoJson::Allocator
+    {
+    public:
+        void* allocate(size_t size) override { return malloc(size); }
+        void deallocate(void* ptr) override { free(ptr); }
+        void* reallocate(void* ptr, size_t new_size) override { return realloc(ptr, new_size); }
+    };
+
+    HeapAllocator heap_allocator;
+
+    /// @brief Reads the text of the JSON input.
+    class Reader
+    {
+    public:
+        Reader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+        bool atEnd() { skipSpace(); return position_ == size_; }
+        char peek() { skipSpace(); return position_ < size_ ? static_cast<char>(data_[position_]) : 0; }
+        void skip() { ++position_; }
+
+        /// @brief Reads a string after its opening quote.
+        DeserializationError::Code readString(std::string& value)
+        {
+            while (position_ < size_)
+            {
+                char c = static_cast<char>(data_[position_++]);
+                if (c == '"')
+                {
+                    return DeserializationError::Ok;
+                }
+                if (c == '\\')
+                {
+                    if (position_ == size_)
+                    {
+                        break;
+                    }
+                    c = static_cast<char>(data_[position_++]);
+                    switch (c)
+                    {
+                    case 'n': c = '\n'; break;
+                    case 't': c = '\t'; break;
+                    case 'r': c = '\r'; break;
+                    case 'b': c = '\b'; break;
+                    case 'f': c = '\f'; break;
+                    case '"': case '\\': case '/': break;
+                    default: return DeserializationError::InvalidInput; // \u escapes are not needed by the API
+                    }
+                }
+                value += c;
+            }
+            return DeserializationError::IncompleteInput;
+        }
+
+        /// @brief Reads a number or a literal (true, false, null).
+        void readToken(std::string& value)
+        {
+            while (position_ < size_ && (isalnum(data_[position_]) || strchr("+-.", data_[position_]) != nullptr))
+            {
+                value += static_cast<char>(data_[position_++]);
+            }
+        }
+
+    private:
+        void skipSpace()
+        {
+            while (position_ < size_ && isspace(data_[position_]))
+            {
+                ++position_;
+            }
+        }
+
+        const uint8_t* data_;
+        size_t size_;
+        size_t position_ = 0;
+    };
+
+    bool validToken(const std::string& token)
+    {
+        if (token == "true" || token == "false" || token == "null")
+        {
+            return true;
+        }
+        char* end = nullptr;
+        strtod(token.c_str(), &end);
+        return !token.empty() && *end == 0;
+    }
+}
+
+JsonDocument::JsonDocument(ArduinoJson::Allocator* allocator) :
+    allocator_(allocator != nullptr ? allocator : &heap_allocator)
+{
+}
+
+JsonDocument::~JsonDocument()
+{
+    clear();
+}
+
+JsonVariantConst JsonDocument::operator[](const char* key) const
+{
+    const Member* member = find(key);
+    return member == nullptr ? JsonVariantConst() : JsonVariantConst(member->value, member->string);
+}
+
+void JsonDocument::clear()
+{
+    while (members_ != nullptr)
+    {
+        Member* next = members_->next;
+        allocator_->deallocate(members_);
+        members_ = next;
+    }
+    object_ = false;
+}
+
+const JsonDocument::Member* JsonDocument::find(const char* key) const
+{
+    for (const Member* member = members_; member != nullptr; member = member->next)
+    {
+        if (strcmp(member->key, key) == 0)
+        {
+            return member;
+        }
+    }
+    return nullptr;
+}
+
+bool JsonDocument::add(const std::string& key, const std::string* value, bool string)
+{
+    const size_t value_size = value == nullptr ? 0 : value->size() + 1;
+    void* block = allocator_->allocate(sizeof(Member) + key.size() + 1 + value_size);
+    if (block == nullptr)
+    {
+        return false;
+    }
+    char* text = static_cast<char*>(block) + sizeof(Member);
+    memcpy(text, key.c_str(), key.size() + 1);
+    const char* value_text = nullptr;
+    if (value != nullptr)
+    {
+        memcpy(text + key.size() + 1, value->c_str(), value_size);
+        value_text = text + key.size() + 1;
+    }
+    // Prepended: the last one of repeated keys is found.
+    members_ = new (block) Member {members_, text, value_text, string};
+    return true;
+}
+
+DeserializationError deserializeJson(JsonDocument& document, const uint8_t* data, size_t size)
+{
+    document.clear();
+    Reader reader(data, size);
+    if (reader.atEnd())
+    {
+        return DeserializationError::EmptyInput;
+    }
+    if (reader.peek() != '{')
+    {
+        return DeserializationError::InvalidInput;
+    }
+    reader.skip();
+    document.object_ = true;
+    if (reader.peek() == '}')
+    {
+        return DeserializationError::Ok;
+    }
+    while (true)
+    {
+        if (reader.atEnd())
+        {
+            return DeserializationError::IncompleteInput;
+        }
+        if (reader.peek() != '"')
+        {
+            return DeserializationError::InvalidInput;
+        }
+        reader.skip();
+        std::string key;
+        auto code = reader.readString(key);
+        if (code != DeserializationError::Ok)
+        {
+            return code;
+        }
+        if (reader.atEnd())
+        {
+            return DeserializationError::IncompleteInput;
+        }
+        if (reader.peek() != ':')
+        {
+            return DeserializationError::InvalidInput;
+        }
+        reader.skip();
+        if (reader.atEnd())
+        {
+            return DeserializationError::IncompleteInput;
+        }
+
+        std::string value;
+        bool string = false;
+        const char first = reader.peek();
+        if (first == '{' || first == '[')
+        {
+            // The API bodies are flat.
+            return DeserializationError::TooDeep;
+        }
+        if (first == '"')
+        {
+            reader.skip();
+            string = true;
+            code = reader.readString(value);
+            if (code != DeserializationError::Ok)
+            {
+                return code;
+            }
+        }
+        else
+        {
+            reader.readToken(value);
+            if (!validToken(value))
+            {
+                return DeserializationError::InvalidInput;
+            }
+        }
+        if (!document.add(key, !string && value == "null" ? nullptr : &value, string))
+        {
+            return DeserializationError::NoMemory;
+        }
+
+        if (reader.atEnd())
+        {
+            return DeserializationError::IncompleteInput;
+        }
+        const char separator = reader.peek();
+        reader.skip();
+        if (separator == '}')
+        {
+            return DeserializationError::Ok;
+        }
+        if (separator != ',')
+        {
+            return DeserializationError::InvalidInput;
+        }
+    }
+}
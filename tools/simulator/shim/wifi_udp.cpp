@@ -0,0 +1,113 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "WiFiUdp.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+WiFiUDP::~WiFiUDP()
+{
+    if (socket_ >= 0)
+    {
+        close(socket_);
+    }
+}
+
+uint8_t WiFiUDP::begin(uint16_t port)
+{
+    socket_ = socket(AF_INET, SOCK_DGRAM, 0);
+    if (socket_ < 0)
+    {
+        return 0;
+    }
+    const int enable = 1;
+    setsockopt(socket_, SOL_SOCKET, SO_BROADCAST, &enable, sizeof(enable));
+    fcntl(socket_, F_SETFL, O_NONBLOCK);
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    return bind(socket_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+}
+
+int WiFiUDP::parsePacket()
+{
+    if (socket_ < 0)
+    {
+        return 0;
+    }
+    received_.resize(1500);
+    sockaddr_in address {};
+    socklen_t address_size = sizeof(address);
+    const auto size = recvfrom(socket_, received_.data(), received_.size(), 0,
+        reinterpret_cast<sockaddr*>(&address), &address_size);
+    if (size <= 0)
+    {
+        received_.clear();
+        return 0;
+    }
+    received_.resize(size);
+    read_offset_ = 0;
+    remote_address_ = IPAddress(address.sin_addr.s_addr);
+    remote_port_ = ntohs(address.sin_port);
+    return static_cast<int>(size);
+}
+
+int WiFiUDP::read(uint8_t* buffer, size_t size)
+{
+    const std::size_t count = std::min(size, received_.size() - read_offset_);
+    memcpy(buffer, received_.data() + read_offset_, count);
+    read_offset_ += count;
+    return static_cast<int>(count);
+}
+
+IPAddress WiFiUDP::remoteIP() const
+{
+    return remote_address_;
+}
+
+uint16_t WiFiUDP::remotePort() const
+{
+    return remote_port_;
+}
+
+int WiFiUDP::beginPacket(IPAddress address, uint16_t port)
+{
+    sending_.clear();
+    send_address_ = address;
+    send_port_ = port;
+    return 1;
+}
+
+size_t WiFiUDP::write(const uint8_t* data, size_t size)
+{
+    sending_.insert(sending_.end(), data, data + size);
+    return size;
+}
+
+int WiFiUDP::endPacket()
+{
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = static_cast<uint32_t>(send_address_);
+    address.sin_port = htons(send_port_);
+    return sendto(socket_, sending_.data(), sending_.size(), 0, reinterpret_cast<sockaddr*>(&address), sizeof(address)) ==
+        static_cast<ssize_t>(sending_.size());
+}
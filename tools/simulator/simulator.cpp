@@ -0,0 +1,357 @@
+// Copyright © 2024 Robert Takacs
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE 
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Host-side simulator measuring how far the shutters end up from their targets.
+//
+// The real controller sources run on a virtual clock: the frames written to the transmit pin are decoded like the
+// receivers do and drive simulated motors with start latency, non-linear speed and end stops. A randomized command
+// script of several days runs in seconds, the distribution of the final position error and of the time to target
+// is reported, with the error of the controller's estimate where a STOP interrupted a motion. The exit status is 1
+// if the final error exceeds the thresholds, so the benchmark can guard the accuracy.
+//
+// Build (from the repository root):
+//   g++ -std=gnu++17 -O2 -Itools/simulator/shim -Isrc tools/simulator/simulator.cpp tools/simulator/motor_model.cpp
+//       tools/simulator/rf_receiver.cpp tools/simulator/shim/arduino_shim.cpp src/command.cpp src/duplicate_filter.cpp
+//       src/event_trace.cpp src/rf_protocol.cpp src/scene.cpp src/shutter.cpp src/shutter_controller.cpp
+//       src/state_snapshot.cpp src/transmitter.cpp src/travel_profile.cpp -o simulator
+// Usage: ./simulator [--days 7] [--seed 1] [--interval-min 20] [--latency-ms 200] [--jitter-ms 100]
+//                    [--curve 0.2] [--speed-error 0.03] [--max-mean-error 4] [--max-p99-error 12]
+// With ideal motors the controller itself is checked, e.g.:
+//   ./simulator --latency-ms 0 --jitter-ms 0 --curve 0 --speed-error 0 --max-mean-error 0.2 --max-p99-error 1
+
+#include "motor_model.h"
+#include "rf_receiver.h"
+#include "shutter_controller.h"
+#include "shutter_params.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace
+{
+    /// @brief The simulation options.
+    struct Options
+    {
+        double days = 7;
+        unsigned seed = 1;
+        /// @brief The mean time between the independent requests [min].
+        double interval_min = 20;
+        /// @brief The mean reaction latency of the motors [ms].
+        double latency_ms = 200;
+        /// @brief The uniform jitter of the reaction latency around the mean [ms].
+        double jitter_ms = 100;
+        /// @brief The non-linearity of the motors' travel, see MotorParams.
+        double curve = 0.2;
+        /// @brief The relative error of the motors' full travel time compared to ShutterParams.
+        double speed_error = 0.03;
+        /// @brief The highest accepted mean |final error| [%].
+        double max_mean_error = 4;
+        /// @brief The highest accepted 99th percentile of the |final error| [%].
+        double max_p99_error = 12;
+    };
+
+    /// @brief The control tick of main.cpp [ms].
+    const unsigned long exec_period_ms = 20;
+    const int transmit_pin = 1;
+    const int shutter_count = Shutter::Device::ALL;
+
+    /// @brief A request waiting for its shutter to settle.
+    struct Pending
+    {
+        bool active = false;
+        uint64_t submit_us = 0;
+        /// @brief The target position, -1 for a STOP interrupting a motion.
+        int target = 0;
+    };
+
+    /// @brief A settled request.
+    struct Sample
+    {
+        /// @brief The actual minus the target position.
+        double error;
+        /// @brief The time from the request until the motor stopped [s].
+        double time_to_target_s;
+    };
+
+    /// @brief The simulated installation: motors listening to the transmit pin.
+    struct Plant
+    {
+        std::array<unsigned char, shutter_count> device_ids {};
+        std::vector<MotorModel> motors;
+        std::mt19937 random;
+        std::uniform_real_distribution<double> jitter {-1, 1};
+        Options options;
+        unsigned long reactions = 0;
+
+        void receive(unsigned char device_id, Instruction instruction, uint64_t time_us)
+        {
+            for (int device = 0; device < shutter_count; ++device)
+            {
+                if (device_id != ShutterParams::all_device_id && device_id != device_ids[device])
+                {
+                    continue;
+                }
+                const double latency_ms = std::max(0.0, options.latency_ms + options.jitter_ms * jitter(random));
+                motors[device].receive(instruction, time_us, static_cast<uint64_t>(1000 * latency_ms));
+                ++reactions;
+            }
+        }
+    };
+
+    double percentile(std::vector<double>& values, double share)
+    {
+        if (values.empty())
+        {
+            return 0;
+        }
+        std::sort(values.begin(), values.end());
+        const std::size_t index = std::min(values.size() - 1, static_cast<std::size_t>(share * values.size()));
+        return values[index];
+    }
+
+    void printDistribution(const char* name, std::vector<double> values, const char* unit)
+    {
+        double sum = 0;
+        for (const auto value : values)
+        {
+            sum += value;
+        }
+        printf("%-22s mean %7.2f  p50 %7.2f  p90 %7.2f  p99 %7.2f  max %7.2f %s\n", name,
+            values.empty() ? 0 : sum / values.size(), percentile(values, 0.5), percentile(values, 0.9),
+            percentile(values, 0.99), percentile(values, 1.0), unit);
+    }
+
+    Options parseOptions(int argc, char** argv)
+    {
+        Options options;
+        for (int i = 1; i + 1 < argc; i += 2)
+        {
+            const double value = atof(argv[i + 1]);
+            if (!strcmp(argv[i], "--days")) options.days = value;
+            else if (!strcmp(argv[i], "--seed")) options.seed = static_cast<unsigned>(value);
+            else if (!strcmp(argv[i], "--interval-min")) options.interval_min = value;
+            else if (!strcmp(argv[i], "--latency-ms")) options.latency_ms = value;
+            else if (!strcmp(argv[i], "--jitter-ms")) options.jitter_ms = value;
+            else if (!strcmp(argv[i], "--curve")) options.curve = value;
+            else if (!strcmp(argv[i], "--speed-error")) options.speed_error = value;
+            else if (!strcmp(argv[i], "--max-mean-error")) options.max_mean_error = value;
+            else if (!strcmp(argv[i], "--max-p99-error")) options.max_p99_error = value;
+            else
+            {
+                fprintf(stderr, "unknown option %s\n", argv[i]);
+                exit(1);
+            }
+        }
+        return options;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const Options options = parseOptions(argc, argv);
+    const auto wall_start = std::chrono::steady_clock::now();
+
+    ShutterController controller(transmit_pin);
+    Plant plant;
+    plant.options = options;
+    plant.random.seed(options.seed);
+    std::mt19937 random(options.seed + 1);
+
+    // The motors differ from the controller's linear travel model in speed, shape and latency.
+    const std::array<std::pair<const TravelProfile::Table*, const TravelProfile::Table*>, shutter_count> tables {{
+        {&ShutterParams::bedroom_window_up, &ShutterParams::bedroom_window_down},
+        {&ShutterParams::bedroom_door_up, &ShutterParams::bedroom_door_down},
+        {&ShutterParams::living_room_window_up, &ShutterParams::living_room_window_down},
+        {&ShutterParams::living_room_door_up, &ShutterParams::living_room_door_down},
+    }};
+    std::uniform_real_distribution<double> speed_error(-options.speed_error, options.speed_error);
+    std::uniform_real_distribution<double> initial_position(0, 100);
+    for (int device = 0; device < shutter_count; ++device)
+    {
+        plant.device_ids[device] = controller.getShutter(static_cast<Shutter::Device>(device)).deviceId();
+        MotorParams params;
+        params.up_ms = tables[device].first->back() * (1 + speed_error(random));
+        params.down_ms = tables[device].second->back() * (1 + speed_error(random));
+        params.curve = options.curve;
+        plant.motors.emplace_back(params, initial_position(random));
+    }
+
+    RfReceiver receiver(
+        [](void* context, unsigned char device_id, Instruction instruction, uint64_t time_us)
+        { static_cast<Plant*>(context)->receive(device_id, instruction, time_us); },
+        &plant);
+    Shim::setPinListener(
+        [](void* context, uint8_t pin, uint8_t level, uint64_t time_us)
+        {
+            if (pin == transmit_pin)
+            {
+                static_cast<RfReceiver*>(context)->onEdge(level, time_us);
+            }
+        },
+        &receiver);
+
+    // The script: independent requests, some followed by quick corrections (retargets, stops).
+    std::exponential_distribution<double> interval_s(1.0 / (60 * options.interval_min));
+    std::uniform_real_distribution<double> correction_s(0.5, 15);
+    std::uniform_int_distribution<int> pick_device(0, shutter_count - 1);
+    std::uniform_int_distribution<int> pick_position(0, 100);
+    std::uniform_real_distribution<double> chance(0, 1);
+
+    std::array<Pending, shutter_count> pending;
+    std::vector<Sample> samples;
+    std::vector<double> stop_estimate_errors;
+    unsigned long requests = 0;
+    unsigned long rejected = 0;
+    unsigned long superseded = 0;
+    int correction_device = -1;
+
+    const uint64_t end_us = static_cast<uint64_t>(options.days * 86400e6);
+    uint64_t next_request_us = static_cast<uint64_t>(1e6 * interval_s(random));
+    unsigned long prev_exec_time_ms = 0;
+    while (Shim::now() < end_us)
+    {
+        // loop(): the next control tick or request, whichever comes first.
+        const uint64_t next_tick_us = 1000ULL * (prev_exec_time_ms + exec_period_ms + 1);
+        const uint64_t wake_us = std::min(next_tick_us, next_request_us);
+        if (Shim::now() < wake_us)
+        {
+            Shim::advance(wake_us - Shim::now());
+        }
+
+        if (Shim::now() >= next_request_us)
+        {
+            const int device = correction_device >= 0 ? correction_device : pick_device(random);
+            Request request;
+            request.device = static_cast<Shutter::Device>(device);
+            int target = -1;
+            const double kind = chance(random);
+            if (kind < 0.55)
+            {
+                request.type = Request::Type::ABSOLUTE;
+                request.position = pick_position(random);
+                target = request.position;
+            }
+            else if (kind < 0.85)
+            {
+                request.type = Request::Type::RELATIVE;
+                request.instruction = chance(random) < 0.5 ? Instruction::UP : Instruction::DOWN;
+                target = request.instruction == Instruction::UP ? 0 : 100;
+            }
+            else if (kind < 0.95)
+            {
+                request.type = Request::Type::RELATIVE;
+                request.instruction = Instruction::STOP;
+            }
+            else
+            {
+                request.type = Request::Type::CALIBRATE;
+                target = 0;
+            }
+
+            ++requests;
+            if (!controller.submit(request))
+            {
+                ++rejected;
+            }
+            else
+            {
+                superseded += pending[device].active;
+                // Once settled, the controller believes to be at the target: only the position where a STOP
+                // interrupted a motion tells how good its estimate is.
+                const bool interrupting = request.type == Request::Type::RELATIVE &&
+                    request.instruction == Instruction::STOP && plant.motors[device].moving(Shim::now());
+                pending[device].active = target >= 0 || interrupting;
+                pending[device].submit_us = Shim::now();
+                pending[device].target = target;
+            }
+
+            const bool correct = correction_device < 0 && chance(random) < 0.3;
+            correction_device = correct ? device : -1;
+            next_request_us = Shim::now() + static_cast<uint64_t>(1e6 * (correct ? correction_s(random) : interval_s(random)));
+        }
+
+        const auto time_ms = millis();
+        if (time_ms - prev_exec_time_ms > exec_period_ms)
+        {
+            // Transmissions advance the virtual clock, just like they block the loop on the board.
+            controller.execute();
+            prev_exec_time_ms = time_ms;
+
+            const uint64_t now_us = Shim::now();
+            for (int device = 0; device < shutter_count; ++device)
+            {
+                const auto& shutter = controller.getShutter(static_cast<Shutter::Device>(device));
+                const auto& motor = plant.motors[device];
+                if (!pending[device].active || shutter.busy() || motor.moving(now_us))
+                {
+                    continue;
+                }
+                pending[device].active = false;
+                const double actual = motor.position(now_us);
+                if (pending[device].target < 0)
+                {
+                    stop_estimate_errors.push_back(std::fabs(shutter.position() - actual));
+                    continue;
+                }
+                samples.push_back({actual - pending[device].target,
+                    (motor.stoppedAt(now_us) - static_cast<double>(pending[device].submit_us)) / 1e6});
+            }
+        }
+    }
+
+    std::vector<double> errors;
+    std::vector<double> times;
+    double bias = 0;
+    std::array<unsigned long, 5> histogram {};
+    const std::array<double, 4> bounds {1, 2, 5, 10};
+    for (const auto& sample : samples)
+    {
+        errors.push_back(std::fabs(sample.error));
+        times.push_back(std::max(0.0, sample.time_to_target_s));
+        bias += sample.error;
+        ++histogram[std::upper_bound(bounds.begin(), bounds.end(), std::fabs(sample.error)) - bounds.begin()];
+    }
+
+    const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    printf("simulated %.1f days in %.1f s: %lu requests, %lu rejected, %lu superseded before settling\n",
+        options.days, wall_s, requests, rejected, superseded);
+    printf("frames decoded %lu (invalid %lu), motor reactions %lu\n", receiver.frames(), receiver.invalidFrames(),
+        plant.reactions);
+    printf("settled requests %zu, mean signed error %.2f %%\n", samples.size(),
+        samples.empty() ? 0 : bias / samples.size());
+    printDistribution("|final error|", errors, "%");
+    printDistribution("|estimate at STOP|", stop_estimate_errors, "%");
+    printDistribution("time to target", times, "s");
+    printf("|final error| histogram: <1 %%: %lu  1-2 %%: %lu  2-5 %%: %lu  5-10 %%: %lu  >=10 %%: %lu\n",
+        histogram[0], histogram[1], histogram[2], histogram[3], histogram[4]);
+    printf("STOPs interrupting a motion %zu\n", stop_estimate_errors.size());
+
+    const double mean_error = errors.empty() ? 0 : std::accumulate(errors.begin(), errors.end(), 0.0) / errors.size();
+    const double p99_error = percentile(errors, 0.99);
+    if (mean_error > options.max_mean_error || p99_error > options.max_p99_error)
+    {
+        printf("FAIL: |final error| mean %.2f %% (max %.2f), p99 %.2f %% (max %.2f)\n", mean_error,
+            options.max_mean_error, p99_error, options.max_p99_error);
+        return 1;
+    }
+    printf("PASS: |final error| mean %.2f %%, p99 %.2f %%\n", mean_error, p99_error);
+    return 0;
+}
@@ -0,0 +1,113 @@
+# Converts an event trace dump (see src/event_trace.h) to the Chrome trace format, viewable in chrome://tracing
+# or https://ui.perfetto.dev.
+#
+# Usage: python trace_to_chrome.py <host or dump file> [-o trace.json]
+import argparse
+import json
+import os
+import struct
+import urllib.request
+
+MAGIC = b"STRC"
+VERSION = 1
+HEADER = struct.Struct("<4sBBHI")
+EVENT = struct.Struct("<IBBH")
+TYPES = ["request", "enqueued", "frame_start", "frame_end", "executing", "done", "tick_overrun"]
+REQUESTS = ["relative", "absolute", "calibrate", "run_scene", "load_scene", "unknown"]
+INSTRUCTIONS = ["up", "down", "stop", "unknown"]
+NO_DEVICE = 0xFF
+
+
+def read_dump(source):
+    if os.path.exists(source):
+        with open(source, "rb") as dump:
+            return dump.read()
+    with urllib.request.urlopen(f"http://{source}/api/trace", timeout=5) as response:
+        return response.read()
+
+
+def parse(data):
+    magic, version, event_size, count, recorded = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION or event_size != EVENT.size:
+        raise SystemExit("not a trace dump")
+    events = []
+    offset = HEADER.size
+    previous, wraps = None, 0
+    for _ in range(count):
+        time_us, kind, device, arg = EVENT.unpack_from(data, offset)
+        offset += EVENT.size
+        # micros() wraps around after ~71 minutes.
+        if previous is not None and time_us < previous and previous - time_us > 1 << 31:
+            wraps += 1
+        previous = time_us
+        events.append((time_us + (wraps << 32), kind, device, arg))
+    return events, recorded - count
+
+
+def track(device):
+    if device == NO_DEVICE:
+        return "loop"
+    return "broadcast" if device == 0 else f"device {device}"
+
+
+def convert(events):
+    trace = []
+    tracks = set()
+    frame_starts = {}
+    open_spans = {}
+    span_count = 0
+    for time_us, kind, device, arg in events:
+        tid = device
+        tracks.add(device)
+        name = TYPES[kind] if kind < len(TYPES) else str(kind)
+        if name == "frame_start":
+            frame_starts[device] = (time_us, arg)
+        elif name == "frame_end" and device in frame_starts:
+            start_us, instruction = frame_starts.pop(device)
+            trace.append({"name": "frame " + INSTRUCTIONS[min(instruction, 3)], "ph": "X", "pid": 0, "tid": tid,
+                          "ts": start_us, "dur": time_us - start_us})
+        elif name == "executing":
+            # A scene step shares its command id across the devices, an absolute command with its trailing STOP:
+            # the span ids are unique per device and span. A shutter executes one command at a time, a command
+            # replaced before it was done ends here.
+            if device in open_spans:
+                trace.append(dict(open_spans.pop(device), ph="e", ts=time_us))
+            span_count += 1
+            open_spans[device] = {"name": f"command {arg}", "cat": "command", "id": f"{device}:{arg}:{span_count}",
+                                  "pid": 0, "tid": tid}
+            trace.append(dict(open_spans[device], ph="b", ts=time_us))
+        elif name == "done":
+            if device in open_spans and open_spans[device]["name"] == f"command {arg}":
+                trace.append(dict(open_spans.pop(device), ph="e", ts=time_us))
+        elif name == "tick_overrun":
+            # Recorded when the late tick starts, the argument is the time since the previous tick.
+            trace.append({"name": f"tick overrun {arg} ms", "ph": "X", "pid": 0, "tid": tid,
+                          "ts": time_us - arg * 1000, "dur": arg * 1000})
+        else:
+            args = {"request": REQUESTS[min(arg, 5)]} if name == "request" else {"command": arg}
+            trace.append({"name": name, "ph": "i", "s": "t", "pid": 0, "tid": tid, "ts": time_us, "args": args})
+    for device in sorted(tracks):
+        trace.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": device, "args": {"name": track(device)}})
+    trace.append({"name": "process_name", "ph": "M", "pid": 0, "args": {"name": "shutter controller"}})
+    return trace
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("source", help="host name of the controller, or a saved dump")
+    parser.add_argument("-o", "--output", default="trace.json")
+    parser.add_argument("--save", help="also save the raw dump to this file")
+    args = parser.parse_args()
+
+    data = read_dump(args.source)
+    if args.save:
+        with open(args.save, "wb") as dump:
+            dump.write(data)
+    events, overwritten = parse(data)
+    with open(args.output, "w") as output:
+        json.dump({"traceEvents": convert(events), "displayTimeUnit": "ms"}, output)
+    print(f"{len(events)} events written to {args.output}, {overwritten} older events were overwritten")
+
+
+if __name__ == "__main__":
+    main()
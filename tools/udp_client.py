@@ -0,0 +1,49 @@
+# Sends a command over the binary UDP control protocol (see src/udp_protocol.h) and prints the state snapshot.
+#
+# Usage: python udp_client.py <host> <opcode> [--devices 0,3] [--argument 40] [--port 5005]
+#   opcodes: state, up, down, stop, move_to, calibrate, run_scene
+import argparse
+import random
+import socket
+import struct
+
+MAGIC = ord("S")
+VERSION = 1
+OPCODES = {"state": 0, "up": 1, "down": 2, "stop": 3, "move_to": 4, "calibrate": 5, "run_scene": 6}
+STATUSES = {0: "ok", 1: "bad request", 2: "rejected"}
+DEVICES = ["bedroom_window", "bedroom_door", "living_window", "living_door"]
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("host")
+    parser.add_argument("opcode", choices=OPCODES.keys())
+    parser.add_argument("--devices", default="", help="comma separated device numbers (0..3)")
+    parser.add_argument("--argument", type=int, default=0, help="target position or scene id")
+    parser.add_argument("--port", type=int, default=5005)
+    parser.add_argument("--timeout", type=float, default=1.0)
+    args = parser.parse_args()
+
+    mask = 0
+    for device in filter(None, args.devices.split(",")):
+        mask |= 1 << int(device)
+    sequence = random.randrange(0x10000)
+    command = struct.pack("<BBHBBBB", MAGIC, VERSION, sequence, mask, OPCODES[args.opcode], args.argument, 0)
+
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as sock:
+        sock.settimeout(args.timeout)
+        sock.sendto(command, (args.host, args.port))
+        reply, _ = sock.recvfrom(64)
+
+    magic, version, reply_sequence, status, count = struct.unpack_from("<BBHBB", reply)
+    if magic != MAGIC or version != VERSION or reply_sequence != sequence:
+        raise SystemExit("unexpected reply: " + reply.hex())
+    print("status:", STATUSES.get(status, status))
+    for device in range(count):
+        position, flags = reply[6 + 2 * device], reply[7 + 2 * device]
+        name = DEVICES[device] if device < len(DEVICES) else str(device)
+        print(f"{name:>16}: {position:3d} %  calibrated={bool(flags & 1)}  busy={bool(flags & 2)}")
+
+
+if __name__ == "__main__":
+    main()